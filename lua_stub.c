@@ -21,6 +21,11 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "multiple.h"
 #include "multiple_err.h"
@@ -30,6 +35,9 @@
 #include "mlua_parser.h"
 #include "mlua_icg.h"
 #include "mlua_optimizer.h"
+#include "mlua_ir_cache.h"
+#include "mlua_stats.h"
+#include "mlua_ir_report.h"
 #include "lua_stub.h"
 
 static int mlua_internal_tokens_print(struct token_list *list)
@@ -39,6 +47,49 @@ static int mlua_internal_tokens_print(struct token_list *list)
     return ret;
 }
 
+/* Map source code file into memory read-only, 
+ * returns 0 and leaves 'code' NULL when mapping is not possible 
+ * so the caller could fall back to reading */
+static int mlua_stub_source_map(struct mlua_stub *stub, char *pathname)
+{
+    int fd;
+    struct stat st;
+    void *addr;
+
+    if ((fd = open(pathname, O_RDONLY)) < 0) return 0;
+    if ((fstat(fd, &st) != 0) || (!S_ISREG(st.st_mode)) || (st.st_size <= 0))
+    {
+        close(fd);
+        return 0;
+    }
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    /* The mapping stays valid after the descriptor closed */
+    close(fd);
+    if (addr == MAP_FAILED) return 0;
+
+    stub->code = (char *)addr;
+    stub->len = (size_t)st.st_size;
+    stub->code_mapped = 1;
+
+    return 0;
+}
+
+static void mlua_stub_source_release(struct mlua_stub *stub)
+{
+    if (stub->code == NULL) return;
+    if (stub->code_mapped != 0)
+    {
+        munmap(stub->code, stub->len);
+    }
+    else
+    {
+        free(stub->code);
+    }
+    stub->code = NULL;
+    stub->len = 0;
+    stub->code_mapped = 0;
+}
+
 int mlua_stub_create(struct multiple_error *err, void **stub_out, \
         char *pathname_dst, int type_dst, \
         char *pathname_src, int type_src)
@@ -63,12 +114,18 @@ int mlua_stub_create(struct multiple_error *err, void **stub_out, \
     new_stub->program = NULL;
     new_stub->code = NULL;
     new_stub->len = 0;
+    new_stub->code_mapped = 0;
     new_stub->debug_info = 0;
     new_stub->optimize = 0;
     new_stub->pathname = NULL;
     new_stub->pathname_len = 0;
 
     new_stub->opt_internal_reconstruct = 0;
+    new_stub->lean = 0;
+    new_stub->released = 0;
+    new_stub->ir_cache = NULL;
+    new_stub->stats_enabled = 0;
+    mlua_stats_init(&new_stub->stats);
 
     if (pathname_src == NULL)
     {
@@ -86,6 +143,10 @@ int mlua_stub_create(struct multiple_error *err, void **stub_out, \
                 goto fail;
                 break;
             case MULTIPLE_IO_PATHNAME:
+                /* Map source code file */
+                mlua_stub_source_map(new_stub, pathname_src);
+                if (new_stub->code_mapped != 0) break;
+
                 /* Open source code file */
                 fp_src = fopen(pathname_src, "rb");
                 if (fp_src == NULL) 
@@ -110,6 +171,7 @@ int mlua_stub_create(struct multiple_error *err, void **stub_out, \
                 if (fread(new_stub->code, (size_t)size_fp, 1, fp_src) < 1) 
                 {
                     multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: reading data from %s failed", pathname_src);
+                    fclose(fp_src);
                     ret = -MULTIPLE_ERR_STUB;
                     goto fail;
                 }
@@ -141,7 +203,7 @@ fail:
     if (new_stub != NULL)
     {
         if (new_stub->pathname != NULL) free(new_stub->pathname);
-        if (new_stub->code != NULL) free(new_stub->code);
+        mlua_stub_source_release(new_stub);
         free(new_stub);
     }
 done:
@@ -159,7 +221,8 @@ int mlua_stub_destroy(void *stub)
     if (stub_ptr->program != NULL) mlua_ast_program_destroy(stub_ptr->program);
     if (stub_ptr->tokens != NULL) token_list_destroy(stub_ptr->tokens);
     if (stub_ptr->pathname != NULL) free(stub_ptr->pathname);
-    if (stub_ptr->code != NULL) free(stub_ptr->code);
+    if (stub_ptr->ir_cache != NULL) mlua_ir_cache_destroy(stub_ptr->ir_cache);
+    mlua_stub_source_release(stub_ptr);
     free(stub_ptr);
 
     return 0;
@@ -179,15 +242,82 @@ int mlua_stub_optimize_set(void *stub, int optimize)
     return 0;
 }
 
+int mlua_stub_lean_set(void *stub, int lean)
+{
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    stub_ptr->lean = lean;
+    return 0;
+}
+
+/* Cache compiled IR in 'dir', disabled when 'dir' is NULL,
+ * a codec without 'encode' or 'decode' is rejected */
+int mlua_stub_ir_cache_set(void *stub, char *dir, struct mlua_ir_cache_codec *codec)
+{
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    struct mlua_ir_cache *new_ir_cache = NULL;
+
+    if ((dir != NULL) && (codec != NULL))
+    {
+        if ((codec->encode == NULL) || (codec->decode == NULL))
+        { return -MULTIPLE_ERR_NULL_PTR; }
+        if ((new_ir_cache = mlua_ir_cache_new(dir, codec)) == NULL)
+        { return -MULTIPLE_ERR_MALLOC; }
+    }
+    if (stub_ptr->ir_cache != NULL) mlua_ir_cache_destroy(stub_ptr->ir_cache);
+    stub_ptr->ir_cache = new_ir_cache;
+    return 0;
+}
+
+static int mlua_stub_source_check(struct multiple_error *err, struct mlua_stub *stub)
+{
+    if (stub->released != 0)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: source code of %s has been released", stub->pathname);
+        return -MULTIPLE_ERR_STUB;
+    }
+    return 0;
+}
+
+static struct mlua_stats *mlua_stub_stats_get(struct mlua_stub *stub)
+{
+    return stub->stats_enabled != 0 ? &stub->stats : NULL;
+}
+
+/* Release front-end data once the IR holds everything needed, 
+ * the AST owns copies of the tokens it keeps */
+static int mlua_stub_lean_release(struct mlua_stub *stub)
+{
+    int ret = 0;
+
+    if (stub->lean == 0) return 0;
+
+    if (stub->tokens != NULL)
+    {
+        if ((ret = token_list_destroy(stub->tokens)) != 0) return ret;
+        stub->tokens = NULL;
+    }
+    if (stub->program != NULL)
+    {
+        if ((ret = mlua_ast_program_destroy(stub->program)) != 0) return ret;
+        stub->program = NULL;
+    }
+    mlua_stub_source_release(stub);
+    stub->released = 1;
+
+    return ret;
+}
+
 static int mlua_stub_tokenize(struct multiple_error *err, struct mlua_stub *stub)
 {
     int ret = 0;
+    struct mlua_stats_probe probe;
 
     if (stub == NULL)
     {
 
         return -MULTIPLE_ERR_NULL_PTR;
     }
+    if ((ret = mlua_stub_source_check(err, stub)) != 0) return ret;
     /* clean */
     if (stub->tokens != NULL) 
     {
@@ -199,7 +329,10 @@ static int mlua_stub_tokenize(struct multiple_error *err, struct mlua_stub *stub
         stub->tokens = NULL;
     }
     /* construct */
+    mlua_stats_probe_begin(mlua_stub_stats_get(stub), &probe);
     if ((ret = mlua_tokenize(err, &stub->tokens, stub->code, stub->len)) != 0) return ret;
+    mlua_stats_probe_end(mlua_stub_stats_get(stub), &probe, MLUA_STATS_PHASE_TOKENIZE);
+    stub->stats.tokens = stub->tokens->size;
 
     return ret;
 }
@@ -207,17 +340,15 @@ static int mlua_stub_tokenize(struct multiple_error *err, struct mlua_stub *stub
 static int mlua_stub_parse(struct multiple_error *err, struct mlua_stub *stub)
 {
     int ret = 0;
+    struct mlua_token_stream *stream = NULL;
+    struct mlua_stats_probe probe;
 
     if (stub == NULL)
     {
         MULTIPLE_ERROR_NULL_PTR();
         return -MULTIPLE_ERR_NULL_PTR;
     }
-    /* dependence */
-    if (stub->tokens == NULL)
-    {
-        if ((ret = mlua_stub_tokenize(err, stub)) != 0) return ret;
-    }
+    if ((ret = mlua_stub_source_check(err, stub)) != 0) return ret;
     /* clean */
     if (stub->program != NULL)
     {
@@ -225,15 +356,50 @@ static int mlua_stub_parse(struct multiple_error *err, struct mlua_stub *stub)
         stub->program = NULL;
     }
     /* construct */
-    if ((ret = mlua_parse(err, &stub->program, stub->tokens)) != 0) return ret;
+    mlua_stats_probe_begin(mlua_stub_stats_get(stub), &probe);
+    if (stub->tokens != NULL)
+    {
+        /* Reuse the token list once it has been built */
+        if ((ret = mlua_parse(err, &stub->program, stub->tokens)) != 0) return ret;
+        if (stub->lean != 0)
+        {
+            if ((ret = token_list_destroy(stub->tokens)) != 0) return ret;
+            stub->tokens = NULL;
+        }
+    }
+    else
+    {
+        /* Pull tokens while parsing rather than keeping all of them */
+        if ((ret = mlua_token_stream_new_from_memory(err, &stream, stub->code, stub->len)) != 0) return ret;
+        ret = mlua_parse_stream(err, &stub->program, stream);
+        /* Tokens are pulled while parsing, the parse phase includes lexing */
+        stub->stats.tokens = stream->count;
+        mlua_token_stream_destroy(stream);
+        if (ret != 0) return ret;
+    }
+    mlua_stats_probe_end(mlua_stub_stats_get(stub), &probe, MLUA_STATS_PHASE_PARSE);
+    if (stub->stats_enabled != 0)
+    { stub->stats.ast_nodes = mlua_ast_program_count_nodes(stub->program); }
 
     return ret;
 }
 
+static void mlua_stub_ir_cache_key(struct mlua_stub *stub, struct mlua_ir_cache_key *key)
+{
+    uint32_t flags = 0;
+
+    if (stub->optimize != 0) flags |= MLUA_IR_CACHE_FLAG_OPTIMIZE;
+    if (stub->debug_info != 0) flags |= MLUA_IR_CACHE_FLAG_DEBUG_INFO;
+    mlua_ir_cache_key_compute(key, stub->code, stub->len, flags);
+}
+
 int mlua_stub_irgen(struct multiple_error *err, struct multiple_ir **icode, void *stub)
 {
     struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
     int ret = 0;
+    struct mlua_ir_cache_key ir_cache_key;
+    struct multiple_ir *icode_cached = NULL;
+    struct mlua_stats_probe probe;
 
     struct optimizer_options options;
     /* Optimization Settings */
@@ -244,15 +410,28 @@ int mlua_stub_irgen(struct multiple_error *err, struct multiple_ir **icode, void
         MULTIPLE_ERROR_NULL_PTR();
         return -MULTIPLE_ERR_NULL_PTR;
     }
-    /* dependence */
-    if (stub_ptr->program == NULL)
+    /* cache */
+    if (stub_ptr->ir_cache != NULL)
     {
-        if ((ret = mlua_stub_parse(err, stub_ptr)) != 0) return ret;
+        if ((ret = mlua_stub_source_check(err, stub_ptr)) != 0) return ret;
+        mlua_stub_ir_cache_key(stub_ptr, &ir_cache_key);
+        if ((ret = mlua_ir_cache_load(err, stub_ptr->ir_cache, &icode_cached, &ir_cache_key, \
+                        stub_ptr->code, stub_ptr->len)) != 0) return ret;
     }
-    /* optimize */
-    if (stub_ptr->optimize != 0)
+    if (icode_cached == NULL)
     {
-        if ((ret = mlua_optimize(err, stub_ptr->program, &options)) != 0) return ret;
+        /* dependence */
+        if (stub_ptr->program == NULL)
+        {
+            if ((ret = mlua_stub_parse(err, stub_ptr)) != 0) return ret;
+        }
+        /* optimize */
+        if (stub_ptr->optimize != 0)
+        {
+            mlua_stats_probe_begin(mlua_stub_stats_get(stub_ptr), &probe);
+            if ((ret = mlua_optimize(err, stub_ptr->program, &options)) != 0) return ret;
+            mlua_stats_probe_end(mlua_stub_stats_get(stub_ptr), &probe, MLUA_STATS_PHASE_OPTIMIZE);
+        }
     }
     /* clean */
     if (*icode != NULL)
@@ -260,19 +439,95 @@ int mlua_stub_irgen(struct multiple_error *err, struct multiple_ir **icode, void
         if ((ret = multiple_ir_destroy(*icode)) != 0) return ret;
         *icode = NULL;
     }
-    /* construct */
-    if ((ret = mlua_irgen(err, icode, stub_ptr->program, stub_ptr->opt_internal_reconstruct)) != 0) return ret;
+    if (icode_cached != NULL)
+    {
+        *icode = icode_cached;
+    }
+    else
+    {
+        /* construct */
+        if ((ret = mlua_irgen(err, icode, stub_ptr->program, \
+                        mlua_stub_stats_get(stub_ptr), \
+                        stub_ptr->opt_internal_reconstruct)) != 0) return ret;
+        if (stub_ptr->ir_cache != NULL)
+        {
+            if ((ret = mlua_ir_cache_store(err, stub_ptr->ir_cache, *icode, &ir_cache_key, \
+                            stub_ptr->code, stub_ptr->len)) != 0) return ret;
+        }
+    }
     /* source code */
     if ((ret = multiple_ir_update_icode_source_code(*icode, stub_ptr->code, stub_ptr->len)) != 0) return ret;
     stub_ptr->opt_internal_reconstruct = 0;
+    /* lean */
+    if ((ret = mlua_stub_lean_release(stub_ptr)) != 0) return ret;
+
+    return ret;
+}
+
+/* Replace the source code, the next reconstruct compiles it */
+int mlua_stub_source_update(struct multiple_error *err, void *stub, char *code, size_t len)
+{
+    int ret = 0;
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    char *new_code = NULL;
+
+    if ((stub_ptr == NULL) || (code == NULL))
+    {
+        MULTIPLE_ERROR_NULL_PTR();
+        return -MULTIPLE_ERR_NULL_PTR;
+    }
+    if ((new_code = (char *)malloc(sizeof(char) * (len + 1))) == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        return -MULTIPLE_ERR_MALLOC;
+    }
+    memcpy(new_code, code, len);
+    new_code[len] = '\0';
+
+    if (stub_ptr->tokens != NULL)
+    {
+        if ((ret = token_list_destroy(stub_ptr->tokens)) != 0) { free(new_code); return ret; }
+        stub_ptr->tokens = NULL;
+    }
+    if (stub_ptr->program != NULL)
+    {
+        if ((ret = mlua_ast_program_destroy(stub_ptr->program)) != 0) { free(new_code); return ret; }
+        stub_ptr->program = NULL;
+    }
+    mlua_stub_source_release(stub_ptr);
+    stub_ptr->code = new_code;
+    stub_ptr->len = len;
+    stub_ptr->released = 0;
 
     return ret;
 }
 
+/* Collect per-phase timing and counters from now on */
+int mlua_stub_stats_set(void *stub, int enabled)
+{
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    stub_ptr->stats_enabled = enabled;
+    if (enabled != 0) mlua_stats_init(&stub_ptr->stats);
+    return 0;
+}
+
+const struct mlua_stats *mlua_stub_stats(void *stub)
+{
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    return &stub_ptr->stats;
+}
+
+int mlua_stub_stats_json_print(FILE *fp, void *stub)
+{
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    return mlua_stats_json_print(fp, &stub_ptr->stats);
+}
+
 int mlua_stub_reconstruct(struct multiple_error *err, struct multiple_ir **ir, void *stub)
 {
     int ret = 0;
     struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    struct mlua_stats_probe probe;
 
     struct optimizer_options options;
     /* Optimization Settings */
@@ -287,25 +542,35 @@ int mlua_stub_reconstruct(struct multiple_error *err, struct multiple_ir **ir, v
     /* dependence */
     if (stub_ptr->program == NULL)
     {
-        if ((ret = mlua_stub_parse(err, stub_ptr)) != 0) return ret;
+        if ((ret = mlua_stub_parse(err, stub_ptr)) != 0) goto fail;
     }
     /* optimize */
     if (stub_ptr->optimize != 0)
     {
-        if ((ret = mlua_optimize(err, stub_ptr->program, &options)) != 0) return ret;
+        mlua_stats_probe_begin(mlua_stub_stats_get(stub_ptr), &probe);
+        if ((ret = mlua_optimize(err, stub_ptr->program, &options)) != 0) goto fail;
+        mlua_stats_probe_end(mlua_stub_stats_get(stub_ptr), &probe, MLUA_STATS_PHASE_OPTIMIZE);
     }
     /* clean */
     if (*ir != NULL)
     {
-        if ((ret = multiple_ir_destroy(*ir)) != 0) return ret;
+        if ((ret = multiple_ir_destroy(*ir)) != 0) goto fail;
         *ir = NULL;
     }
     /* construct */
     stub_ptr->opt_internal_reconstruct = 1;
-    if ((ret = mlua_irgen(err, ir, stub_ptr->program, stub_ptr->opt_internal_reconstruct)) != 0) return ret;
+    if ((ret = mlua_irgen(err, ir, stub_ptr->program, \
+                    mlua_stub_stats_get(stub_ptr), \
+                    stub_ptr->opt_internal_reconstruct)) != 0) goto fail;
     /* source code */
-    if ((ret = multiple_ir_update_icode_source_code(*ir, stub_ptr->code, stub_ptr->len)) != 0) return ret;
+    if ((ret = multiple_ir_update_icode_source_code(*ir, stub_ptr->code, stub_ptr->len)) != 0) goto fail;
 
+    /* lean */
+    if ((ret = mlua_stub_lean_release(stub_ptr)) != 0) goto fail;
+
+    goto done;
+fail:
+done:
     return ret;
 }
 
@@ -323,7 +588,7 @@ int mlua_stub_tokens_print(struct multiple_error *err, void *stub)
     /* dependence */
     if (stub_ptr->tokens == NULL) 
     {
-        if ((ret = mlua_tokenize(err, &stub_ptr->tokens, stub_ptr->code, stub_ptr->len)) != 0) return ret;
+        if ((ret = mlua_stub_tokenize(err, stub_ptr)) != 0) return ret;
     }
     /* work */
     if ((ret = mlua_internal_tokens_print(stub_ptr->tokens)) != 0) return ret;
@@ -331,3 +596,27 @@ int mlua_stub_tokens_print(struct multiple_error *err, void *stub)
     return ret;
 }
 
+int mlua_stub_ir_report_print(struct multiple_error *err, void *stub)
+{
+    int ret = 0;
+    struct mlua_stub *stub_ptr = (struct mlua_stub *)stub;
+    struct multiple_ir *icode = NULL;
+
+    if (stub == NULL) 
+    {
+        MULTIPLE_ERROR_NULL_PTR();
+        return -MULTIPLE_ERR_NULL_PTR;
+    }
+
+    /* dependence */
+    if ((ret = mlua_stub_irgen(err, &icode, stub_ptr)) != 0) goto fail;
+    /* work */
+    if ((ret = mlua_ir_report_print(err, stdout, icode)) != 0) goto fail;
+
+    goto done;
+fail:
+done:
+    if (icode != NULL) multiple_ir_destroy(icode);
+    return ret;
+}
+
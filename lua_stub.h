@@ -23,6 +23,8 @@
 #include <stdio.h>
 
 #include "multiple_ir.h"
+#include "mlua_ir_cache.h"
+#include "mlua_stats.h"
 
 #define MLUA_FRONTNAME "lua"
 #define MLUA_FULLNAME "Lua"
@@ -33,6 +35,9 @@ struct mlua_stub
     /* plain text of source code */
     char *code;
     size_t len;
+    /* 'code' is a read-only mapping of the source file 
+     * rather than an allocated copy */
+    int code_mapped;
 
     /* debug info */
     int debug_info;
@@ -47,6 +52,18 @@ struct mlua_stub
     /* options */
     int opt_internal_reconstruct;
 
+    /* lean lifecycle: drop tokens after parsing, 
+     * AST and source code after generating IR */
+    int lean;
+    int released;
+
+    /* compiled IR cache, NULL when disabled */
+    struct mlua_ir_cache *ir_cache;
+
+    /* per-phase timing and counters, collected when enabled */
+    int stats_enabled;
+    struct mlua_stats stats;
+
     /* pathname */
     char *pathname;
     size_t pathname_len;
@@ -58,8 +75,15 @@ int mlua_stub_create(struct multiple_error *err, void **stub_out, \
 int mlua_stub_destroy(void *stub);
 int mlua_stub_debug_info_set(void *stub, int debug_info);
 int mlua_stub_optimize_set(void *stub, int optimize);
+int mlua_stub_lean_set(void *stub, int lean);
+int mlua_stub_ir_cache_set(void *stub, char *dir, struct mlua_ir_cache_codec *codec);
 int mlua_stub_tokens_print(struct multiple_error *err, void *stub);
+int mlua_stub_ir_report_print(struct multiple_error *err, void *stub);
+int mlua_stub_source_update(struct multiple_error *err, void *stub, char *code, size_t len);
 int mlua_stub_reconstruct(struct multiple_error *err, struct multiple_ir **ir, void *stub);
+int mlua_stub_stats_set(void *stub, int enabled);
+const struct mlua_stats *mlua_stub_stats(void *stub);
+int mlua_stub_stats_json_print(FILE *fp, void *stub);
 int mlua_stub_irgen(struct multiple_error *err, struct multiple_ir **ir, void *stub);
 
 #endif
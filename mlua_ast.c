@@ -1654,3 +1654,246 @@ int mlua_ast_program_destroy(struct mlua_ast_program *program)
     return 0;
 }
 
+
+/* Node Count */
+
+static size_t mlua_ast_statement_list_count_nodes(struct mlua_ast_statement_list *list);
+static size_t mlua_ast_expression_count_nodes(struct mlua_ast_expression *exp);
+
+static size_t mlua_ast_expression_list_count_nodes(struct mlua_ast_expression_list *list)
+{
+    size_t count = 0;
+    struct mlua_ast_expression *exp_cur;
+
+    if (list == NULL) return 0;
+    exp_cur = list->begin;
+    while (exp_cur != NULL)
+    {
+        count += mlua_ast_expression_count_nodes(exp_cur);
+        exp_cur = exp_cur->next;
+    }
+
+    return count;
+}
+
+static size_t mlua_ast_args_count_nodes(struct mlua_ast_args *args);
+
+static size_t mlua_ast_fieldlist_count_nodes(struct mlua_ast_fieldlist *fieldlist)
+{
+    size_t count = 0;
+    struct mlua_ast_field *field_cur;
+
+    if (fieldlist == NULL) return 0;
+    field_cur = fieldlist->begin;
+    while (field_cur != NULL)
+    {
+        count++;
+        switch (field_cur->type)
+        {
+            case MLUA_AST_FIELD_TYPE_ARRAY:
+                count += mlua_ast_expression_count_nodes(field_cur->u.array->index);
+                count += mlua_ast_expression_count_nodes(field_cur->u.array->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_PROPERTY:
+                count += mlua_ast_expression_count_nodes(field_cur->u.property->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_EXP:
+                count += mlua_ast_expression_count_nodes(field_cur->u.exp->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_UNKNOWN:
+                break;
+        }
+        field_cur = field_cur->next;
+    }
+
+    return count;
+}
+
+static size_t mlua_ast_funcall_count_nodes(struct mlua_ast_expression_funcall *funcall)
+{
+    size_t count = 0;
+
+    if (funcall == NULL) return 0;
+    count += mlua_ast_expression_count_nodes(funcall->prefixexp);
+    count += mlua_ast_args_count_nodes(funcall->args);
+
+    return count;
+}
+
+static size_t mlua_ast_args_count_nodes(struct mlua_ast_args *args)
+{
+    if (args == NULL) return 0;
+    switch (args->type)
+    {
+        case MLUA_AST_ARGS_TYPE_EXPLIST:
+            return mlua_ast_expression_list_count_nodes(args->u.explist);
+        case MLUA_AST_ARGS_TYPE_TBLCTOR:
+            if (args->u.tblctor == NULL) return 0;
+            return mlua_ast_fieldlist_count_nodes(args->u.tblctor->fieldlist);
+        case MLUA_AST_ARGS_TYPE_STRING:
+        case MLUA_AST_ARGS_TYPE_UNKNOWN:
+            break;
+    }
+
+    return 0;
+}
+
+static size_t mlua_ast_expression_count_nodes(struct mlua_ast_expression *exp)
+{
+    size_t count = 1;
+
+    if (exp == NULL) return 0;
+    switch (exp->type)
+    {
+        case MLUA_AST_EXPRESSION_TYPE_PREFIX:
+            if (exp->u.prefix == NULL) break;
+            if (exp->u.prefix->type == MLUA_AST_PREFIX_EXP_TYPE_FUNCALL)
+            { count += mlua_ast_funcall_count_nodes(exp->u.prefix->u.funcall); }
+            else if (exp->u.prefix->type == MLUA_AST_PREFIX_EXP_TYPE_EXP)
+            { count += mlua_ast_expression_count_nodes(exp->u.prefix->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_PRIMARY:
+            if ((exp->u.primary != NULL) && \
+                    (exp->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_EXPR))
+            { count += mlua_ast_expression_count_nodes(exp->u.primary->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_SUFFIXED:
+            if (exp->u.suffixed == NULL) break;
+            count += mlua_ast_expression_count_nodes(exp->u.suffixed->sub);
+            if (exp->u.suffixed->type == MLUA_AST_EXPRESSION_SUFFIXED_TYPE_INDEX)
+            { count += mlua_ast_expression_count_nodes(exp->u.suffixed->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_TBLCTOR:
+            if (exp->u.tblctor != NULL)
+            { count += mlua_ast_fieldlist_count_nodes(exp->u.tblctor->fieldlist); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_FUNCALL:
+            count += mlua_ast_funcall_count_nodes(exp->u.funcall);
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_FUNDEF:
+            if (exp->u.fundef != NULL)
+            { count += mlua_ast_statement_list_count_nodes(exp->u.fundef->body); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_UNOP:
+            if (exp->u.unop != NULL)
+            { count += mlua_ast_expression_count_nodes(exp->u.unop->sub); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_BINOP:
+            if (exp->u.binop == NULL) break;
+            count += mlua_ast_expression_count_nodes(exp->u.binop->left);
+            count += mlua_ast_expression_count_nodes(exp->u.binop->right);
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_FACTOR:
+        case MLUA_AST_EXPRESSION_TYPE_UNKNOWN:
+            break;
+    }
+
+    return count;
+}
+
+static size_t mlua_ast_statement_count_nodes(struct mlua_ast_statement *stmt)
+{
+    size_t count = 1;
+    struct mlua_ast_statement_elseif *elseif_cur;
+
+    switch (stmt->type)
+    {
+        case MLUA_AST_STATEMENT_TYPE_ASSIGNMENT:
+            if (stmt->u.stmt_assignment == NULL) break;
+            count += mlua_ast_expression_list_count_nodes(stmt->u.stmt_assignment->varlist);
+            count += mlua_ast_expression_list_count_nodes(stmt->u.stmt_assignment->explist);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_EXPR:
+            if (stmt->u.stmt_expr != NULL)
+            { count += mlua_ast_expression_count_nodes(stmt->u.stmt_expr->expr); }
+            break;
+        case MLUA_AST_STATEMENT_TYPE_FUNCALL:
+            count += mlua_ast_funcall_count_nodes(stmt->u.funcall);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_IF:
+            if (stmt->u.stmt_if == NULL) break;
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_if->exp);
+            count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_if->block_then);
+            elseif_cur = stmt->u.stmt_if->elseif;
+            while (elseif_cur != NULL)
+            {
+                count += mlua_ast_expression_count_nodes(elseif_cur->exp);
+                count += mlua_ast_statement_list_count_nodes(elseif_cur->block_then);
+                elseif_cur = elseif_cur->elseif;
+            }
+            count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_if->block_else);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_WHILE:
+            if (stmt->u.stmt_while == NULL) break;
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_while->exp);
+            count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_while->block);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_REPEAT:
+            if (stmt->u.stmt_repeat == NULL) break;
+            count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_repeat->block);
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_repeat->exp);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_DO:
+            if (stmt->u.stmt_do != NULL)
+            { count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_do->block); }
+            break;
+        case MLUA_AST_STATEMENT_TYPE_FOR:
+            if (stmt->u.stmt_for == NULL) break;
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_for->exp1);
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_for->exp2);
+            count += mlua_ast_expression_count_nodes(stmt->u.stmt_for->exp3);
+            count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_for->block);
+            break;
+        case MLUA_AST_STATEMENT_TYPE_LOCAL:
+            if (stmt->u.stmt_local != NULL)
+            { count += mlua_ast_expression_list_count_nodes(stmt->u.stmt_local->explist); }
+            break;
+        case MLUA_AST_STATEMENT_TYPE_FUNDEF:
+            if (stmt->u.stmt_fundef != NULL)
+            { count += mlua_ast_statement_list_count_nodes(stmt->u.stmt_fundef->body); }
+            break;
+        case MLUA_AST_STATEMENT_TYPE_RETURN:
+            if (stmt->u.stmt_return != NULL)
+            { count += mlua_ast_expression_list_count_nodes(stmt->u.stmt_return->explist); }
+            break;
+        case MLUA_AST_STATEMENT_TYPE_BREAK:
+        case MLUA_AST_STATEMENT_TYPE_LABEL:
+        case MLUA_AST_STATEMENT_TYPE_GOTO:
+        case MLUA_AST_STATEMENT_TYPE_UNKNOWN:
+            break;
+    }
+
+    return count;
+}
+
+static size_t mlua_ast_statement_list_count_nodes(struct mlua_ast_statement_list *list)
+{
+    size_t count = 0;
+    struct mlua_ast_statement *stmt_cur;
+
+    if (list == NULL) return 0;
+    stmt_cur = list->begin;
+    while (stmt_cur != NULL)
+    {
+        count += mlua_ast_statement_count_nodes(stmt_cur);
+        stmt_cur = stmt_cur->next;
+    }
+
+    return count;
+}
+
+/* Statements, expressions and table fields */
+size_t mlua_ast_program_count_nodes(struct mlua_ast_program *program)
+{
+    if (program == NULL) return 0;
+    return mlua_ast_statement_list_count_nodes(program->stmts);
+}
+
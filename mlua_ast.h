@@ -616,6 +616,7 @@ struct mlua_ast_program
 };
 struct mlua_ast_program *mlua_ast_program_new(void);
 int mlua_ast_program_destroy(struct mlua_ast_program *program);
+size_t mlua_ast_program_count_nodes(struct mlua_ast_program *program);
 
 
 #endif
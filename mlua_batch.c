@@ -0,0 +1,166 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "multiple.h"
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "lua_stub.h"
+#include "mlua_batch.h"
+
+/* Each task owns its stub, and through it its token list, AST,
+ * codegen context and IR. The frontend shares nothing else
+ * between tasks than the built-in handler, priority and token
+ * name tables, which are all const */
+
+struct mlua_batch_pool
+{
+    struct mlua_batch_task *tasks;
+    size_t count;
+    struct mlua_batch_options *options;
+
+    /* Next task to take and count of failures */
+    pthread_mutex_t lock;
+    size_t next;
+    size_t failed;
+};
+
+static int mlua_batch_compile_task(struct mlua_batch_task *task, \
+        struct mlua_batch_options *options)
+{
+    int ret = 0;
+    struct multiple_error *err = task->err;
+    void *stub = NULL;
+    struct multiple_ir *icode = NULL;
+
+    task->icode = NULL;
+
+    if ((ret = mlua_stub_create(err, &stub, \
+                    NULL, MULTIPLE_IO_NULL, \
+                    task->pathname, MULTIPLE_IO_PATHNAME)) != 0)
+    { goto fail; }
+    mlua_stub_optimize_set(stub, options->optimize);
+    mlua_stub_debug_info_set(stub, options->debug_info);
+    mlua_stub_lean_set(stub, options->lean);
+    if (options->ir_cache_dir != NULL)
+    {
+        if ((ret = mlua_stub_ir_cache_set(stub, \
+                        options->ir_cache_dir, \
+                        options->ir_cache_codec)) != 0)
+        { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    }
+    if ((ret = mlua_stub_irgen(err, &icode, stub)) != 0)
+    { goto fail; }
+
+    task->icode = icode;
+
+    goto done;
+fail:
+done:
+    if (stub != NULL) mlua_stub_destroy(stub);
+    task->ret = ret;
+    return ret;
+}
+
+static void *mlua_batch_worker(void *data)
+{
+    struct mlua_batch_pool *pool = data;
+    size_t idx;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pool->lock);
+        idx = pool->next;
+        if (idx != pool->count) pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        if (idx == pool->count) break;
+
+        if (mlua_batch_compile_task(&pool->tasks[idx], pool->options) != 0)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->failed++;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return NULL;
+}
+
+static size_t mlua_batch_workers_count(size_t workers, size_t count)
+{
+    long online;
+
+    if (workers == 0)
+    {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 0 ? (size_t)online : 1;
+    }
+    if (workers > MLUA_BATCH_WORKERS_MAX) workers = MLUA_BATCH_WORKERS_MAX;
+    if (workers > count) workers = count;
+
+    return workers;
+}
+
+size_t mlua_batch_compile(struct mlua_batch_task *tasks, size_t count, \
+        size_t workers, struct mlua_batch_options *options)
+{
+    struct mlua_batch_pool pool;
+    pthread_t threads[MLUA_BATCH_WORKERS_MAX];
+    size_t started = 0;
+    size_t idx;
+
+    if (count == 0) return 0;
+
+    for (idx = 0; idx != count; idx++)
+    {
+        tasks[idx].icode = NULL;
+        tasks[idx].ret = 0;
+    }
+
+    pool.tasks = tasks;
+    pool.count = count;
+    pool.options = options;
+    pool.next = 0;
+    pool.failed = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    workers = mlua_batch_workers_count(workers, count);
+    /* The calling thread is one of the workers */
+    while (started + 1 < workers)
+    {
+        if (pthread_create(&threads[started], NULL, mlua_batch_worker, &pool) != 0) break;
+        started++;
+    }
+    mlua_batch_worker(&pool);
+    for (idx = 0; idx != started; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    pthread_mutex_destroy(&pool.lock);
+
+    return pool.failed;
+}
+
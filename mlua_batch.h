@@ -0,0 +1,64 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_BATCH_H_
+#define _MLUA_BATCH_H_
+
+#include <stdio.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "mlua_ir_cache.h"
+
+/* Upper bound of workers, 0 asks for one per online processor */
+#define MLUA_BATCH_WORKERS_MAX 64
+
+/* One source file, filled in by the caller except
+ * 'icode' and 'ret' which are the outcome */
+struct mlua_batch_task
+{
+    char *pathname;
+
+    /* Per task, a failure of one file does not abort the others */
+    struct multiple_error *err;
+
+    struct multiple_ir *icode;
+    int ret;
+};
+
+struct mlua_batch_options
+{
+    int optimize;
+    int debug_info;
+    int lean;
+
+    /* Compiled IR cache shared by all tasks, NULL when disabled */
+    char *ir_cache_dir;
+    struct mlua_ir_cache_codec *ir_cache_codec;
+};
+
+/* Compile every task on a pool of 'workers' threads,
+ * returns the count of failed tasks, their causes are
+ * left in 'ret' and 'err' of each task */
+size_t mlua_batch_compile(struct mlua_batch_task *tasks, size_t count, \
+        size_t workers, struct mlua_batch_options *options);
+
+#endif
+
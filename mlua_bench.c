@@ -0,0 +1,401 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+#include "multiply_lexer.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_parser.h"
+#include "mlua_optimizer.h"
+#include "mlua_icg.h"
+#include "mlua_stats.h"
+#include "mlua_bench.h"
+
+/* Size of the small sources */
+#define MLUA_BENCH_SMALL_SIZE (4 * 1024)
+
+/* Nesting of each line of the deep expression corpus */
+#define MLUA_BENCH_EXPRESSION_DEPTH 64
+
+static const char *mlua_bench_corpus_names[MLUA_BENCH_CORPUS_COUNT] =
+{
+    "small",
+    "deep_expression",
+    "table_literal",
+    "closure",
+    "goto",
+};
+
+const char *mlua_bench_corpus_name(enum mlua_bench_corpus corpus)
+{
+    if ((int)corpus < 0 || corpus >= MLUA_BENCH_CORPUS_COUNT) return NULL;
+    return mlua_bench_corpus_names[corpus];
+}
+
+struct mlua_bench_buffer
+{
+    char *body;
+    size_t size;
+    size_t capacity;
+};
+
+static int mlua_bench_buffer_append(struct mlua_bench_buffer *buffer, const char *str)
+{
+    size_t len = strlen(str);
+    size_t new_capacity;
+    char *new_body;
+
+    if (buffer->size + len + 1 > buffer->capacity)
+    {
+        new_capacity = buffer->capacity;
+        while (buffer->size + len + 1 > new_capacity) new_capacity *= 2;
+        new_body = (char *)realloc(buffer->body, sizeof(char) * new_capacity);
+        if (new_body == NULL) return -MULTIPLE_ERR_MALLOC;
+        buffer->body = new_body;
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->body + buffer->size, str, len);
+    buffer->size += len;
+    buffer->body[buffer->size] = '\0';
+
+    return 0;
+}
+
+/* One unit of source of 'corpus', 'idx' keeps names apart */
+static int mlua_bench_corpus_unit(struct mlua_bench_buffer *buffer, \
+        enum mlua_bench_corpus corpus, size_t idx)
+{
+    int ret = 0;
+    char line[256];
+    size_t depth;
+
+    switch (corpus)
+    {
+        case MLUA_BENCH_CORPUS_SMALL:
+            sprintf(line, "local x%lu = %lu\n" \
+                    "local function f%lu(a, b) return a + b * 2 end\n" \
+                    "print(f%lu(x%lu, \"s\" .. x%lu))\n", \
+                    (unsigned long)idx, (unsigned long)idx, \
+                    (unsigned long)idx, (unsigned long)idx, \
+                    (unsigned long)idx, (unsigned long)idx);
+            ret = mlua_bench_buffer_append(buffer, line);
+            break;
+
+        case MLUA_BENCH_CORPUS_DEEP_EXPRESSION:
+            sprintf(line, "local e%lu = ", (unsigned long)idx);
+            if ((ret = mlua_bench_buffer_append(buffer, line)) != 0) break;
+            for (depth = 0; depth != MLUA_BENCH_EXPRESSION_DEPTH; depth++)
+            {
+                if ((ret = mlua_bench_buffer_append(buffer, "(")) != 0) return ret;
+            }
+            if ((ret = mlua_bench_buffer_append(buffer, "1")) != 0) break;
+            for (depth = 0; depth != MLUA_BENCH_EXPRESSION_DEPTH; depth++)
+            {
+                sprintf(line, " %c %lu)", "+-*"[depth % 3], (unsigned long)(depth + 2));
+                if ((ret = mlua_bench_buffer_append(buffer, line)) != 0) return ret;
+            }
+            ret = mlua_bench_buffer_append(buffer, "\n");
+            break;
+
+        case MLUA_BENCH_CORPUS_TABLE_LITERAL:
+            /* Fields of one table, opened and closed by the caller */
+            sprintf(line, "    %lu, k%lu = \"v%lu\", {%lu, %lu},\n", \
+                    (unsigned long)idx, (unsigned long)idx, (unsigned long)idx, \
+                    (unsigned long)idx, (unsigned long)(idx + 1));
+            ret = mlua_bench_buffer_append(buffer, line);
+            break;
+
+        case MLUA_BENCH_CORPUS_CLOSURE:
+            sprintf(line, "local function mk%lu(a)\n" \
+                    "    return function(b)\n" \
+                    "        return function(c) return a + b + c end\n" \
+                    "    end\n" \
+                    "end\n", (unsigned long)idx);
+            ret = mlua_bench_buffer_append(buffer, line);
+            break;
+
+        case MLUA_BENCH_CORPUS_GOTO:
+            sprintf(line, "do\n" \
+                    "    local i = 0\n" \
+                    "    ::top%lu::\n" \
+                    "    i = i + 1\n" \
+                    "    if i < 10 then goto top%lu end\n" \
+                    "end\n", (unsigned long)idx, (unsigned long)idx);
+            ret = mlua_bench_buffer_append(buffer, line);
+            break;
+
+        case MLUA_BENCH_CORPUS_COUNT:
+            break;
+    }
+
+    return ret;
+}
+
+int mlua_bench_corpus_generate(struct multiple_error *err, \
+        char **code_out, size_t *len_out, \
+        enum mlua_bench_corpus corpus, size_t size)
+{
+    int ret = 0;
+    struct mlua_bench_buffer buffer;
+    size_t idx = 0;
+
+    *code_out = NULL;
+    *len_out = 0;
+
+    buffer.size = 0;
+    buffer.capacity = 4096;
+    if ((buffer.body = (char *)malloc(sizeof(char) * buffer.capacity)) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    buffer.body[0] = '\0';
+
+    if (corpus == MLUA_BENCH_CORPUS_TABLE_LITERAL)
+    {
+        if ((ret = mlua_bench_buffer_append(&buffer, "local t = {\n")) != 0)
+        { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    }
+    while (buffer.size < size)
+    {
+        if ((ret = mlua_bench_corpus_unit(&buffer, corpus, idx++)) != 0)
+        { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    }
+    if (corpus == MLUA_BENCH_CORPUS_TABLE_LITERAL)
+    {
+        if ((ret = mlua_bench_buffer_append(&buffer, "}\n")) != 0)
+        { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    }
+
+    *code_out = buffer.body;
+    *len_out = buffer.size;
+    buffer.body = NULL;
+
+    goto done;
+fail:
+done:
+    if (buffer.body != NULL) free(buffer.body);
+    return ret;
+}
+
+int mlua_bench_run(struct multiple_error *err, \
+        struct mlua_bench_result *result, \
+        const char *name, \
+        const char *code, size_t len, \
+        size_t iterations)
+{
+    int ret = 0;
+    size_t iteration;
+    struct mlua_stats stats;
+    struct mlua_stats_probe probe;
+    struct mlua_token_stream *stream = NULL;
+    struct token *token;
+    struct mlua_ast_program *program = NULL;
+    struct multiple_ir *icode = NULL;
+    struct optimizer_options options;
+
+    options.constant_folding = 1;
+
+    memset(result, 0, sizeof(struct mlua_bench_result));
+    result->name = name;
+    result->bytes = len;
+    result->iterations = iterations;
+    mlua_stats_init(&stats);
+
+    for (iteration = 0; iteration != iterations; iteration++)
+    {
+        /* Lexer, drains a token stream the way the parser pulls it */
+        if ((ret = mlua_token_stream_new_from_memory(err, &stream, code, len)) != 0) goto fail;
+        mlua_stats_probe_begin(&stats, &probe);
+        token = mlua_token_stream_first(stream);
+        while (token != NULL) token = mlua_token_next(token);
+        mlua_stats_probe_end(&stats, &probe, MLUA_STATS_PHASE_TOKENIZE);
+        if ((ret = stream->ret) != 0) goto fail;
+        result->tokens = stream->count;
+        mlua_token_stream_destroy(stream); stream = NULL;
+
+        /* Parser, pulls tokens as the stub does, so it includes lexing */
+        if ((ret = mlua_token_stream_new_from_memory(err, &stream, code, len)) != 0) goto fail;
+        mlua_stats_probe_begin(&stats, &probe);
+        if ((ret = mlua_parse_stream(err, &program, stream)) != 0) goto fail;
+        mlua_stats_probe_end(&stats, &probe, MLUA_STATS_PHASE_PARSE);
+        mlua_token_stream_destroy(stream); stream = NULL;
+        result->ast_nodes = mlua_ast_program_count_nodes(program);
+
+        /* Optimizer */
+        mlua_stats_probe_begin(&stats, &probe);
+        if ((ret = mlua_optimize(err, program, &options)) != 0) goto fail;
+        mlua_stats_probe_end(&stats, &probe, MLUA_STATS_PHASE_OPTIMIZE);
+
+        /* ICG, records generation and merging itself */
+        if ((ret = mlua_irgen(err, &icode, program, &stats, 0)) != 0) goto fail;
+        multiple_ir_destroy(icode); icode = NULL;
+        mlua_ast_program_destroy(program); program = NULL;
+    }
+
+    result->lexer = stats.phases[MLUA_STATS_PHASE_TOKENIZE].wall;
+    result->parser = stats.phases[MLUA_STATS_PHASE_PARSE].wall;
+    result->optimizer = stats.phases[MLUA_STATS_PHASE_OPTIMIZE].wall;
+    result->icg = stats.phases[MLUA_STATS_PHASE_IRGEN].wall + \
+                  stats.phases[MLUA_STATS_PHASE_MERGE].wall;
+    result->instruments = stats.instruments;
+
+    goto done;
+fail:
+done:
+    if (stream != NULL) mlua_token_stream_destroy(stream);
+    if (program != NULL) mlua_ast_program_destroy(program);
+    if (icode != NULL) multiple_ir_destroy(icode);
+    return ret;
+}
+
+/* ru_maxrss is a high-water mark over the whole process, 
+ * so every run is done in a child of its own */
+static int mlua_bench_run_isolated(struct multiple_error *err, \
+        struct mlua_bench_result *result, \
+        const char *name, \
+        const char *code, size_t len, \
+        size_t iterations)
+{
+    int ret = 0;
+    int fds[2];
+    pid_t pid;
+    int status;
+    struct rusage usage;
+    ssize_t read_len;
+
+    if (pipe(fds) != 0)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_INTERNAL, "error: can not create pipe for benchmark %s", name);
+        return -MULTIPLE_ERR_INTERNAL;
+    }
+    if ((pid = fork()) == -1)
+    {
+        close(fds[0]); close(fds[1]);
+        multiple_error_update(err, -MULTIPLE_ERR_INTERNAL, "error: can not fork for benchmark %s", name);
+        return -MULTIPLE_ERR_INTERNAL;
+    }
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+        ret = mlua_bench_run(err, result, name, code, len, iterations);
+        if ((ret != 0) || \
+                (write(fds[1], result, sizeof(struct mlua_bench_result)) != \
+                 (ssize_t)sizeof(struct mlua_bench_result)))
+        { _exit(1); }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    read_len = read(fds[0], result, sizeof(struct mlua_bench_result));
+    close(fds[0]);
+    if (wait4(pid, &status, 0, &usage) == -1) { status = 1; }
+    if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != 0) || \
+            (read_len != (ssize_t)sizeof(struct mlua_bench_result)))
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_INTERNAL, "error: benchmark %s failed", name);
+        return -MULTIPLE_ERR_INTERNAL;
+    }
+    result->name = name;
+    result->peak_rss = (long)usage.ru_maxrss;
+
+    return 0;
+}
+
+static double mlua_bench_rate(double amount, double seconds)
+{
+    if (seconds <= 0.0) return 0.0;
+    return amount / seconds;
+}
+
+int mlua_bench_result_json_print(FILE *fp, struct mlua_bench_result *result)
+{
+    double mb = (double)result->bytes * (double)result->iterations / (1024.0 * 1024.0);
+    double nodes = (double)result->ast_nodes * (double)result->iterations;
+
+    fprintf(fp, "{\"name\": \"%s\", \"bytes\": %lu, \"iterations\": %lu, " \
+            "\"lexer_mb_s\": %.3f, \"parser_mb_s\": %.3f, \"parser_nodes_s\": %.0f, " \
+            "\"optimizer_nodes_s\": %.0f, \"icg_nodes_s\": %.0f, " \
+            "\"tokens\": %lu, \"ast_nodes\": %lu, \"instruments\": %lu, " \
+            "\"peak_rss_kib\": %ld}\n", \
+            result->name, \
+            (unsigned long)result->bytes, (unsigned long)result->iterations, \
+            mlua_bench_rate(mb, result->lexer), \
+            mlua_bench_rate(mb, result->parser), \
+            mlua_bench_rate(nodes, result->parser), \
+            mlua_bench_rate(nodes, result->optimizer), \
+            mlua_bench_rate(nodes, result->icg), \
+            (unsigned long)result->tokens, \
+            (unsigned long)result->ast_nodes, \
+            (unsigned long)result->instruments, \
+            result->peak_rss);
+
+    return 0;
+}
+
+int mlua_bench_suite_run(struct multiple_error *err, FILE *fp, \
+        size_t size, size_t iterations)
+{
+    int ret = 0;
+    int corpus;
+    size_t size_idx;
+    size_t sizes[2];
+    char name[64];
+    char *code = NULL;
+    size_t len;
+    struct mlua_bench_result result;
+
+    sizes[0] = MLUA_BENCH_SMALL_SIZE;
+    sizes[1] = size;
+
+    for (corpus = 0; corpus != MLUA_BENCH_CORPUS_COUNT; corpus++)
+    {
+        for (size_idx = 0; size_idx != 2; size_idx++)
+        {
+            if ((ret = mlua_bench_corpus_generate(err, &code, &len, \
+                            (enum mlua_bench_corpus)corpus, sizes[size_idx])) != 0)
+            { goto fail; }
+            sprintf(name, "%s_%s", mlua_bench_corpus_names[corpus], \
+                    size_idx == 0 ? "small" : "large");
+            if ((ret = mlua_bench_run_isolated(err, &result, name, code, len, iterations)) != 0)
+            { goto fail; }
+            mlua_bench_result_json_print(fp, &result);
+            free(code); code = NULL;
+        }
+    }
+
+    goto done;
+fail:
+done:
+    if (code != NULL) free(code);
+    return ret;
+}
+
@@ -0,0 +1,88 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_BENCH_H_
+#define _MLUA_BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "multiple_err.h"
+
+/* Size of the generated large sources */
+#define MLUA_BENCH_LARGE_SIZE (10 * 1024 * 1024)
+
+enum mlua_bench_corpus
+{
+    MLUA_BENCH_CORPUS_SMALL = 0,
+    MLUA_BENCH_CORPUS_DEEP_EXPRESSION,
+    MLUA_BENCH_CORPUS_TABLE_LITERAL,
+    MLUA_BENCH_CORPUS_CLOSURE,
+    MLUA_BENCH_CORPUS_GOTO,
+    MLUA_BENCH_CORPUS_COUNT
+};
+
+struct mlua_bench_result
+{
+    const char *name;
+    size_t bytes;
+    size_t iterations;
+
+    /* Seconds of wall time, summed over the iterations, 
+     * the parser pulls its tokens from a stream, so it includes lexing */
+    double lexer;
+    double parser;
+    double optimizer;
+    double icg;
+
+    /* Of one iteration */
+    size_t tokens;
+    size_t ast_nodes;
+    size_t instruments;
+
+    /* Peak resident set of the child that did the run in KiB, 
+     * only filled in by mlua_bench_suite_run */
+    long peak_rss;
+};
+
+const char *mlua_bench_corpus_name(enum mlua_bench_corpus corpus);
+
+/* Generate a source of the kind of 'corpus' of about 'size' bytes */
+int mlua_bench_corpus_generate(struct multiple_error *err, \
+        char **code_out, size_t *len_out, \
+        enum mlua_bench_corpus corpus, size_t size);
+
+/* Run lexer, parser, optimizer and icg on 'code' separately,
+ * 'iterations' times each */
+int mlua_bench_run(struct multiple_error *err, \
+        struct mlua_bench_result *result, \
+        const char *name, \
+        const char *code, size_t len, \
+        size_t iterations);
+
+/* One line of JSON per result, lines of two runs diff cleanly */
+int mlua_bench_result_json_print(FILE *fp, struct mlua_bench_result *result);
+
+/* Every corpus, small sources and sources of 'size' bytes, 
+ * each run in a forked child */
+int mlua_bench_suite_run(struct multiple_error *err, FILE *fp, \
+        size_t size, size_t iterations);
+
+#endif
+
@@ -0,0 +1,44 @@
+/* Multiple Lua Programming Language : Hash
+ * Copyright(C) 2014 Cheryl Natsu
+
+ * This file is part of multiple - Multiple Paradigm Language Interpreter
+
+ * multiple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * multiple is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#include "selfcheck.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "mlua_hash.h"
+
+uint64_t mlua_hash_fnv1a_update(uint64_t hash, const char *data, size_t len)
+{
+    size_t idx;
+
+    for (idx = 0; idx != len; idx++)
+    {
+        hash ^= (uint64_t)(unsigned char)data[idx];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+uint64_t mlua_hash_fnv1a(const char *data, size_t len)
+{
+    return mlua_hash_fnv1a_update(MLUA_HASH_FNV1A_INIT, data, len);
+}
+
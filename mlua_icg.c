@@ -43,12 +43,16 @@
 
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_context.h"
+#include "mlua_icg_inline.h"
 
 #include "mlua_icg_expr.h"
 #include "mlua_icg_stmt.h"
 
 #include "mlua_icg_built_in_proc.h"
 #include "mlua_icg_built_in_table.h"
+#include "mlua_icg_stdlib_io.h"
+
+#include "mlua_stats.h"
 
 /* Declaration */
 int mlua_icodegen_statement_list(struct multiple_error *err, \
@@ -65,27 +69,43 @@ static int mlua_icodegen_merge_blocks(struct multiple_error *err, \
     int ret = 0;
     struct mlua_icg_fcb_block *icg_fcb_block_cur;
     struct mlua_icg_fcb_line *icg_fcb_line_cur;
+    size_t idx;
 
     uint32_t instrument_number;
     struct multiple_ir_export_section_item *export_section_item_cur;
-    struct multiple_ir_text_section_item *text_section_item_cur;
 
-    uint32_t offset_start;
-    uint32_t fcb_size = 0;
+    /* Absolute instrument number of each block, 
+     * the operand of lambda mk is the index number of its block */
+    uint32_t *block_instrument_numbers = NULL;
+    size_t block_count = context->icg_fcb_block_list->size;
+    size_t block_idx;
 
-    uint32_t count;
+    if ((block_instrument_numbers = (uint32_t *)malloc( \
+                    sizeof(uint32_t) * (block_count + 1))) == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        ret = -MULTIPLE_ERR_MALLOC;
+        goto fail;
+    }
 
 	/* Do not disturb the instrument produced by other way */
-	offset_start = (uint32_t)(context->icode->text_section->size);
-	
-	export_section_item_cur = context->icode->export_section->begin;
+    instrument_number = (uint32_t)(context->icode->text_section->size);
+    block_idx = 0;
     icg_fcb_block_cur = context->icg_fcb_block_list->begin;
     while (icg_fcb_block_cur != NULL)
     {
-        icg_fcb_line_cur = icg_fcb_block_cur->begin;
+        block_instrument_numbers[block_idx++] = instrument_number;
+        instrument_number += (uint32_t)(icg_fcb_block_cur->size);
+        icg_fcb_block_cur = icg_fcb_block_cur->next;
+    }
 
+	export_section_item_cur = context->icode->export_section->begin;
+    block_idx = 0;
+    icg_fcb_block_cur = context->icg_fcb_block_list->begin;
+    while (icg_fcb_block_cur != NULL)
+    {
         /* Record the absolute instrument number */
-        instrument_number = (uint32_t)context->icode->text_section->size;
+        instrument_number = block_instrument_numbers[block_idx];
         if (export_section_item_cur == NULL)
         {
             MULTIPLE_ERROR_INTERNAL();
@@ -94,8 +114,9 @@ static int mlua_icodegen_merge_blocks(struct multiple_error *err, \
         }
         export_section_item_cur->instrument_number = instrument_number;
 
-        while (icg_fcb_line_cur != NULL)
+        for (idx = 0; idx != icg_fcb_block_cur->size; idx++)
         {
+            icg_fcb_line_cur = icg_fcb_block_cur->lines[idx];
             switch (icg_fcb_line_cur->type)
             {
                 case MLUA_ICG_FCB_LINE_TYPE_NORMAL:
@@ -112,9 +133,15 @@ static int mlua_icodegen_merge_blocks(struct multiple_error *err, \
                     break;
                 case MLUA_ICG_FCB_LINE_TYPE_LAMBDA_MK:
                     /* Operand of this instrument here is the index number of lambda */
+                    if (icg_fcb_line_cur->operand >= block_count)
+                    {
+                        MULTIPLE_ERROR_INTERNAL();
+                        ret = -MULTIPLE_ERR_INTERNAL;
+                        goto fail;
+                    }
                     if ((ret = multiply_icodegen_text_section_append(err, \
                                     context->icode, \
-                                    icg_fcb_line_cur->opcode, icg_fcb_line_cur->operand)) != 0)
+                                    icg_fcb_line_cur->opcode, block_instrument_numbers[icg_fcb_line_cur->operand])) != 0)
                     { goto fail; }
                     break;
                 case MLUA_ICG_FCB_LINE_TYPE_BLTIN_PROC_MK:
@@ -124,57 +151,17 @@ static int mlua_icodegen_merge_blocks(struct multiple_error *err, \
                     { goto fail; }
                     break;
             }
-
-            fcb_size += 1;
-            icg_fcb_line_cur = icg_fcb_line_cur->next;
         }
 
+        block_idx++;
         icg_fcb_block_cur = icg_fcb_block_cur->next;
         export_section_item_cur = export_section_item_cur->next;
     }
 
-    /* 2nd pass, dealing with lambdas */
-    icg_fcb_block_cur = context->icg_fcb_block_list->begin;
-    /* Skip text body of built-in procedures at the beginning part */
-    text_section_item_cur = context->icode->text_section->begin;
-    while (offset_start-- > 0)
-    {
-        text_section_item_cur = text_section_item_cur->next; 
-    }
-    /* Process lambda mks */
-    while (icg_fcb_block_cur != NULL)
-    {
-        icg_fcb_line_cur = icg_fcb_block_cur->begin;
-        while (icg_fcb_line_cur != NULL)
-        {
-            if (icg_fcb_line_cur->type == MLUA_ICG_FCB_LINE_TYPE_LAMBDA_MK)
-            {
-                /* Locate to the export section item */
-                count = icg_fcb_line_cur->operand;
-                export_section_item_cur = context->icode->export_section->begin;
-                while ((export_section_item_cur != NULL) && (count != 0))
-                {
-                    count--;
-                    export_section_item_cur = export_section_item_cur->next;
-                }
-                if (export_section_item_cur == NULL)
-                {
-                    MULTIPLE_ERROR_INTERNAL();
-                    ret = -MULTIPLE_ERR_INTERNAL;
-                    goto fail;
-                }
-                text_section_item_cur->operand = export_section_item_cur->instrument_number; 
-            }
-            text_section_item_cur = text_section_item_cur->next; 
-            icg_fcb_line_cur = icg_fcb_line_cur->next;
-        }
-
-        icg_fcb_block_cur = icg_fcb_block_cur->next;
-    }
-
     goto done;
 fail:
 done:
+    if (block_instrument_numbers != NULL) free(block_instrument_numbers);
     return ret;
 }
 
@@ -232,6 +219,76 @@ done:
     return ret;
 }
 
+/* The closures of the chunks given to 'load' are made in a function 
+ * of their own called once from the prologue, the frame they are 
+ * made in has none of the locals of the main chunk */
+static int mlua_icodegen_chunks(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block_prologue, \
+        struct mlua_icg_fcb_block *icg_fcb_block_chunks)
+{
+    int ret = 0;
+    uint32_t id;
+    struct multiple_ir_export_section_item *new_export_section_item = NULL;
+
+    new_export_section_item = multiple_ir_export_section_item_new();
+    if (new_export_section_item == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        ret = -MULTIPLE_ERR_MALLOC;
+        goto fail;
+    }
+    new_export_section_item->blank = 1;
+
+    /* Return an empty list */
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_chunks, \
+                    OP_LSTMK, 0)) != 0) { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_chunks, \
+                    OP_RETURN, 0)) != 0) { goto fail; }
+
+    /* Call it without arguments and drop what it returns */
+    if ((ret = multiply_resource_get_int( \
+                    err, \
+                    context->icode, \
+                    context->res_id, \
+                    &id, \
+                    0)) != 0)
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_prologue, \
+                    OP_PUSH, id)) != 0) { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure_type(icg_fcb_block_prologue, \
+                    OP_LAMBDAMK, (uint32_t)(context->icg_fcb_block_list->size), \
+                    MLUA_ICG_FCB_LINE_TYPE_LAMBDA_MK)) != 0) { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_prologue, \
+                    OP_FUNCMK, 0)) != 0) { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_prologue, \
+                    OP_CALLC, 0)) != 0) { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block_prologue, \
+                    OP_DROP, 0)) != 0) { goto fail; }
+
+    /* Append block */
+    if ((ret = mlua_icg_fcb_block_list_append(context->icg_fcb_block_list, icg_fcb_block_chunks)) != 0)
+    {
+        MULTIPLE_ERROR_INTERNAL();
+        goto fail;
+    }
+    icg_fcb_block_chunks = NULL;
+    /* Append blank export section */
+    if ((ret = multiple_ir_export_section_append(context->icode->export_section, new_export_section_item)) != 0)
+    {
+        MULTIPLE_ERROR_INTERNAL();
+        goto fail;
+    }
+    new_export_section_item = NULL;
+
+    goto done;
+fail:
+    if (icg_fcb_block_chunks != NULL) mlua_icg_fcb_block_destroy(icg_fcb_block_chunks);
+    if (new_export_section_item != NULL) multiple_ir_export_section_item_destroy(new_export_section_item);
+done:
+    return ret;
+}
+
 
 static int mlua_icodegen_program(struct multiple_error *err, \
         struct mlua_icg_context *context, \
@@ -239,11 +296,14 @@ static int mlua_icodegen_program(struct multiple_error *err, \
 {
     int ret = 0;
     struct mlua_icg_fcb_block *new_icg_fcb_block_autorun = NULL;
+    struct mlua_icg_fcb_block *new_icg_fcb_block_prologue = NULL;
+    struct mlua_icg_fcb_block *new_icg_fcb_block_chunks = NULL;
     struct mlua_map_offset_label_list *new_map_offset_label_list = NULL;
     uint32_t id;
     struct multiple_ir_export_section_item *new_export_section_item = NULL;
     uint32_t instrument_number_insert_point_built_in_proc;
     uint32_t instrument_count_built_in_proc;
+    uint32_t instrument_number_stdout_flush;
 
     new_icg_fcb_block_autorun = mlua_icg_fcb_block_new();
     if (new_icg_fcb_block_autorun == NULL) 
@@ -252,6 +312,20 @@ static int mlua_icodegen_program(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_MALLOC;
         goto fail;
     }
+    new_icg_fcb_block_prologue = mlua_icg_fcb_block_new();
+    if (new_icg_fcb_block_prologue == NULL) 
+    {
+        MULTIPLE_ERROR_MALLOC();
+        ret = -MULTIPLE_ERR_MALLOC;
+        goto fail;
+    }
+    new_icg_fcb_block_chunks = mlua_icg_fcb_block_new();
+    if (new_icg_fcb_block_chunks == NULL) 
+    {
+        MULTIPLE_ERROR_MALLOC();
+        ret = -MULTIPLE_ERR_MALLOC;
+        goto fail;
+    }
     new_map_offset_label_list = mlua_map_offset_label_list_new();
     if (new_map_offset_label_list == NULL)
     {
@@ -286,11 +360,15 @@ static int mlua_icodegen_program(struct multiple_error *err, \
     instrument_number_insert_point_built_in_proc = mlua_icg_fcb_block_get_instrument_number(new_icg_fcb_block_autorun);
 
     /* Statements of top level */
-    if ((ret = mlua_icodegen_statement_list(err, context, \
-                    new_icg_fcb_block_autorun, \
-                    new_map_offset_label_list, \
-                    program->stmts, NULL)) != 0)
-    { goto fail; }
+    context->icg_fcb_block_autorun = new_icg_fcb_block_autorun;
+    context->icg_fcb_block_chunks = new_icg_fcb_block_chunks;
+    ret = mlua_icodegen_statement_list(err, context, \
+            new_icg_fcb_block_autorun, \
+            new_map_offset_label_list, \
+            program->stmts, NULL);
+    context->icg_fcb_block_autorun = NULL;
+    context->icg_fcb_block_chunks = NULL;
+    if (ret != 0) { goto fail; }
 
     /* Apply goto to label */
     if ((ret = mlua_icodegen_statement_list_apply_goto(err, \
@@ -301,28 +379,109 @@ static int mlua_icodegen_program(struct multiple_error *err, \
     /* Pop a label offset pack */
     multiply_offset_item_pack_stack_pop(context->offset_item_pack_stack);
 
+    /* Write out what is left in the buffer of standard output */
+    if ((context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
+                    context->icode, \
+                    context->res_id, \
+                    &context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH], \
+
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+
+                    MULTIPLY_ASM_FINISH)) != 0))
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
+                    new_icg_fcb_block_autorun, \
+                    context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH])) != 0)
+    { goto fail; }
+
     /* Put built-in procedures directly into icode,
-     * and put initialize code into '__autorun__' */
+     * and collect initialize code for '__autorun__' */
     if ((ret = mlua_icg_add_built_in_procs(err, \
                     context->icode, \
                     context->res_id, \
-                    new_icg_fcb_block_autorun, \
+                    new_icg_fcb_block_prologue, \
                     context->customizable_built_in_procedure_list, \
-                    instrument_number_insert_point_built_in_proc,
+                    0,
                     &instrument_count_built_in_proc)) != 0)
     { goto fail; }
 
     /* Put built-in 'tables' directly into icode,
-     * and put initialize code into '__autorun__' */
+     * and collect initialize code for '__autorun__' */
     if ((ret = mlua_icg_add_built_in_tables(err, \
                     context->icode, \
                     context->res_id, \
-                    new_icg_fcb_block_autorun, \
+                    new_icg_fcb_block_prologue, \
                     context->stdlibs, \
-                    instrument_number_insert_point_built_in_proc,
+                    0,
                     &instrument_count_built_in_proc)) != 0)
     { goto fail; }
 
+    /* Procedure writing out standard output, in a hidden global */
+    instrument_number_stdout_flush = (uint32_t)(context->icode->text_section->size);
+    if ((ret = mlua_icg_add_built_in_procs_io_stdout_flush(err, \
+                    context->icode, \
+                    context->res_id)) != 0)
+    { goto fail; }
+    if ((ret = multiply_resource_get_id( \
+                    err, \
+                    context->icode, \
+                    context->res_id, \
+                    &id, \
+                    MLUA_ICG_STDLIB_IO_FLUSH, \
+                    strlen(MLUA_ICG_STDLIB_IO_FLUSH))) != 0)
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure_type(new_icg_fcb_block_prologue, \
+                    OP_LAMBDAMK, instrument_number_stdout_flush, \
+                    MLUA_ICG_FCB_LINE_TYPE_BLTIN_PROC_MK)) != 0)
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(new_icg_fcb_block_prologue, \
+                    OP_POPG, id)) != 0)
+    { goto fail; }
+
+    /* Line buffered standard output with nothing pending */
+    if ((context->templates[MLUA_ICG_TEMPLATE_IO_INIT] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
+                    context->icode, \
+                    context->res_id, \
+                    &context->templates[MLUA_ICG_TEMPLATE_IO_INIT], \
+
+                    MULTIPLY_ASM_OP_STR , OP_PUSH      , "line",
+                    MULTIPLY_ASM_OP_ID  , OP_POPG      , MLUA_ICG_STDLIB_IO_MODE,
+                    MULTIPLY_ASM_OP_INT , OP_PUSH      , MLUA_ICG_STDLIB_IO_BUFFER_SIZE,
+                    MULTIPLY_ASM_OP_ID  , OP_POPG      , MLUA_ICG_STDLIB_IO_LIMIT,
+                    MULTIPLY_ASM_OP_RAW , OP_HASHMK    , 0,
+                    MULTIPLY_ASM_OP_ID  , OP_POPG      , MLUA_ICG_STDLIB_IO_BUFFER,
+                    MULTIPLY_ASM_OP_INT , OP_PUSH      , 0,
+                    MULTIPLY_ASM_OP_ID  , OP_POPG      , MLUA_ICG_STDLIB_IO_COUNT,
+                    MULTIPLY_ASM_OP_INT , OP_PUSH      , 0,
+                    MULTIPLY_ASM_OP_ID  , OP_POPG      , MLUA_ICG_STDLIB_IO_PENDING,
+
+                    MULTIPLY_ASM_FINISH)) != 0))
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
+                    new_icg_fcb_block_prologue, \
+                    context->templates[MLUA_ICG_TEMPLATE_IO_INIT])) != 0)
+    { goto fail; }
+
+    /* Closures of the chunks given to 'load', after the built-in 
+     * procedures and before any statement of the program */
+    if (mlua_icg_fcb_block_get_instrument_number(new_icg_fcb_block_chunks) != 0)
+    {
+        ret = mlua_icodegen_chunks(err, \
+                context, \
+                new_icg_fcb_block_prologue, \
+                new_icg_fcb_block_chunks);
+        new_icg_fcb_block_chunks = NULL;
+        if (ret != 0) { goto fail; }
+    }
+
+    /* Put initialize code into '__autorun__' in one go */
+    if ((ret = mlua_icg_fcb_block_insert_block(new_icg_fcb_block_autorun, \
+                    instrument_number_insert_point_built_in_proc, \
+                    new_icg_fcb_block_prologue)) != 0)
+    { goto fail; }
+
     /* '__autorun__' subroutine */
     if ((ret = mlua_icodegen_special( \
                     err, \
@@ -349,17 +508,44 @@ static int mlua_icodegen_program(struct multiple_error *err, \
 fail:
     if (new_icg_fcb_block_autorun != NULL) mlua_icg_fcb_block_destroy(new_icg_fcb_block_autorun);
 done:
+    if (new_icg_fcb_block_prologue != NULL) mlua_icg_fcb_block_destroy(new_icg_fcb_block_prologue);
+    if (new_icg_fcb_block_chunks != NULL) mlua_icg_fcb_block_destroy(new_icg_fcb_block_chunks);
     if (new_export_section_item != NULL) multiple_ir_export_section_item_destroy(new_export_section_item);
     if (new_map_offset_label_list != NULL) mlua_map_offset_label_list_destroy(new_map_offset_label_list);
     return ret;
 }
 
+static void mlua_irgen_stats_count(struct mlua_stats *stats, \
+        struct mlua_icg_context *context)
+{
+    struct mlua_icg_fcb_block *icg_fcb_block_cur;
+    size_t idx;
+
+    stats->fcb_lines = 0;
+    stats->lambdas = 0;
+    icg_fcb_block_cur = context->icg_fcb_block_list->begin;
+    while (icg_fcb_block_cur != NULL)
+    {
+        stats->fcb_lines += icg_fcb_block_cur->size;
+        for (idx = 0; idx != icg_fcb_block_cur->size; idx++)
+        {
+            if (icg_fcb_block_cur->lines[idx]->type == MLUA_ICG_FCB_LINE_TYPE_LAMBDA_MK)
+            { stats->lambdas++; }
+        }
+        icg_fcb_block_cur = icg_fcb_block_cur->next;
+    }
+    stats->resource_ids = context->icode->data_section->size;
+    stats->instruments = context->icode->text_section->size;
+}
+
 int mlua_irgen(struct multiple_error *err, \
         struct multiple_ir **icode_out, \
         struct mlua_ast_program *program, \
+        struct mlua_stats *stats, \
         int verbose)
 {
     int ret = 0;
+    struct mlua_stats_probe probe;
     struct mlua_icg_context context;
     struct mlua_icg_fcb_block_list *new_icg_fcb_block_list = NULL;
     struct multiple_ir *new_icode = NULL;
@@ -370,6 +556,8 @@ int mlua_irgen(struct multiple_error *err, \
 
     (void)verbose;
 
+    mlua_icg_context_init(&context);
+
     if ((new_customizable_built_in_procedure_list = mlua_icg_customizable_built_in_procedure_list_new()) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
@@ -388,7 +576,6 @@ int mlua_irgen(struct multiple_error *err, \
     if ((new_res_id = multiply_resource_id_pool_new()) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
-    mlua_icg_context_init(&context);
     context.icg_fcb_block_list = new_icg_fcb_block_list;
     context.icode = new_icode;
     context.res_id = new_res_id;
@@ -396,16 +583,34 @@ int mlua_irgen(struct multiple_error *err, \
     context.offset_item_pack_stack = new_offset_item_pack_stack;
     context.stdlibs = new_table_list;
 
+    /* Names the program and the chunks it loads shadow 
+     * the standard library with */
+    if ((context.inline_bindings = mlua_icg_inline_bindings_new()) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    if ((context.chunks = mlua_icg_chunk_map_new()) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    if ((ret = mlua_icg_inline_bindings_collect(err, \
+                    context.inline_bindings, \
+                    context.chunks, \
+                    program->stmts)) != 0)
+    { goto fail; }
+
     /* Generating icode for '__init__' */
+    mlua_stats_probe_begin(stats, &probe);
     if ((ret = mlua_icodegen_program(err, \
                     &context, \
                     program)) != 0)
     { goto fail; }
+    mlua_stats_probe_end(stats, &probe, MLUA_STATS_PHASE_IRGEN);
 
     /* Merge blocks */
+    mlua_stats_probe_begin(stats, &probe);
     if ((ret = mlua_icodegen_merge_blocks(err, \
                     &context)) != 0)
     { goto fail; }
+    mlua_stats_probe_end(stats, &probe, MLUA_STATS_PHASE_MERGE);
+
+    if (stats != NULL) mlua_irgen_stats_count(stats, &context);
 
     *icode_out = new_icode;
 
@@ -422,6 +627,7 @@ done:
     { multiply_offset_item_pack_stack_destroy(new_offset_item_pack_stack); }
     if (new_table_list != NULL)
     { mlua_icg_stdlib_table_list_destroy(new_table_list); }
+    mlua_icg_context_uninit(&context);
     return ret;
 }
 
@@ -25,10 +25,12 @@
 #include "mlua_ast.h"
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_context.h"
+#include "mlua_stats.h"
 
 int mlua_irgen(struct multiple_error *err, \
         struct multiple_ir **icode_out, \
         struct mlua_ast_program *program, \
+        struct mlua_stats *stats, \
         int verbose);
 
 #endif
@@ -33,6 +33,7 @@
 #include "mlua_icg.h"
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_aux.h"
+#include "mlua_hash.h"
 
 int mlua_icg_fcb_block_append_from_precompiled_pic_text( \
         struct mlua_icg_fcb_block *icg_fcb_block, \
@@ -56,9 +57,44 @@ fail:
 }
 
 
+struct mlua_map_label *mlua_map_label_new(char *str, size_t len, uint32_t hash)
+{
+    struct mlua_map_label *new_label = NULL;
+
+    new_label = (struct mlua_map_label *)malloc(sizeof(struct mlua_map_label));
+    if (new_label == NULL) { goto fail; }
+    new_label->next = NULL;
+    new_label->len = len;
+    new_label->hash = hash;
+    new_label->defined = 0;
+    new_label->offset = 0;
+    new_label->str = (char *)malloc(sizeof(char) * (len + 1));
+    if (new_label->str == NULL) { goto fail; }
+    memcpy(new_label->str, str, len);
+    new_label->str[len] = '\0';
+
+    goto done;
+fail:
+    if (new_label != NULL)
+    {
+        mlua_map_label_destroy(new_label);
+        new_label = NULL;
+    }
+done:
+    return new_label;
+}
+
+int mlua_map_label_destroy(struct mlua_map_label *label)
+{
+    if (label->str != NULL) free(label->str);
+    free(label);
+
+    return 0;
+}
+
 struct mlua_map_offset_label *mlua_map_offset_label_new( \
         uint32_t offset, \
-        char *str, size_t len, \
+        struct mlua_map_label *label, \
         uint32_t pos_ln, uint32_t pos_col)
 {
     struct mlua_map_offset_label *new_mlua_map_offset_label = NULL;
@@ -67,28 +103,19 @@ struct mlua_map_offset_label *mlua_map_offset_label_new( \
     if (new_mlua_map_offset_label == NULL) { goto fail; }
     new_mlua_map_offset_label->prev = new_mlua_map_offset_label->next = NULL;
     new_mlua_map_offset_label->offset = offset;
-    new_mlua_map_offset_label->len = len;
-    new_mlua_map_offset_label->str = (char *)malloc(sizeof(char) * (len + 1));
-    if (new_mlua_map_offset_label->str == NULL) { goto fail; }
-    memcpy(new_mlua_map_offset_label->str, str, len);
-    new_mlua_map_offset_label->str[len] = '\0';
+    new_mlua_map_offset_label->label = label;
     new_mlua_map_offset_label->pos_ln = pos_ln;
     new_mlua_map_offset_label->pos_col = pos_col;
 
     goto done;
 fail:
-    if (new_mlua_map_offset_label != NULL)
-    {
-        mlua_map_offset_label_destroy(new_mlua_map_offset_label);
-        new_mlua_map_offset_label = NULL;
-    }
 done:
     return new_mlua_map_offset_label;
 }
 
 int mlua_map_offset_label_destroy(struct mlua_map_offset_label *mlua_map_offset_label)
 {
-    if (mlua_map_offset_label->str != NULL) free(mlua_map_offset_label->str);
+    /* The label is owned by the list */
     free(mlua_map_offset_label);
 
     return 0;
@@ -101,6 +128,11 @@ struct mlua_map_offset_label_list *mlua_map_offset_label_list_new(void)
     new_list = (struct mlua_map_offset_label_list *)malloc(sizeof(struct mlua_map_offset_label_list));
     if (new_list == NULL) { goto fail; }
     new_list->begin = new_list->end = NULL;
+    new_list->labels_capacity = MLUA_MAP_LABEL_TABLE_INIT_SIZE;
+    new_list->labels_size = 0;
+    new_list->labels = (struct mlua_map_label **)calloc( \
+            new_list->labels_capacity, sizeof(struct mlua_map_label *));
+    if (new_list->labels == NULL) { goto fail; }
 
     goto done;
 fail:
@@ -116,6 +148,8 @@ done:
 int mlua_map_offset_label_list_destroy(struct mlua_map_offset_label_list *list)
 {
     struct mlua_map_offset_label *mlua_map_offset_label_cur, *mlua_map_offset_label_next;
+    struct mlua_map_label *label_cur, *label_next;
+    size_t idx;
 
     mlua_map_offset_label_cur = list->begin;
     while (mlua_map_offset_label_cur != NULL)
@@ -124,6 +158,20 @@ int mlua_map_offset_label_list_destroy(struct mlua_map_offset_label_list *list)
         mlua_map_offset_label_destroy(mlua_map_offset_label_cur);
         mlua_map_offset_label_cur = mlua_map_offset_label_next; 
     }
+    if (list->labels != NULL)
+    {
+        for (idx = 0; idx != list->labels_capacity; idx++)
+        {
+            label_cur = list->labels[idx];
+            while (label_cur != NULL)
+            {
+                label_next = label_cur->next; 
+                mlua_map_label_destroy(label_cur);
+                label_cur = label_next; 
+            }
+        }
+        free(list->labels);
+    }
     free(list);
 
     return 0;
@@ -146,6 +194,69 @@ int mlua_map_offset_label_list_append(struct mlua_map_offset_label_list *list, \
     return 0;
 }
 
+/* Double the buckets when the load factor exceeds 1 */
+static int mlua_map_offset_label_list_rehash(struct mlua_map_offset_label_list *list)
+{
+    struct mlua_map_label **new_labels = NULL;
+    struct mlua_map_label *label_cur, *label_next;
+    size_t new_capacity = list->labels_capacity * 2;
+    size_t idx;
+
+    new_labels = (struct mlua_map_label **)calloc( \
+            new_capacity, sizeof(struct mlua_map_label *));
+    if (new_labels == NULL) { return -1; }
+
+    for (idx = 0; idx != list->labels_capacity; idx++)
+    {
+        label_cur = list->labels[idx];
+        while (label_cur != NULL)
+        {
+            label_next = label_cur->next; 
+            label_cur->next = new_labels[label_cur->hash & (new_capacity - 1)];
+            new_labels[label_cur->hash & (new_capacity - 1)] = label_cur;
+            label_cur = label_next; 
+        }
+    }
+    free(list->labels);
+    list->labels = new_labels;
+    list->labels_capacity = new_capacity;
+
+    return 0;
+}
+
+/* Get the interned label with the specified name, create it if not exists */
+static struct mlua_map_label *mlua_map_offset_label_list_intern( \
+        struct mlua_map_offset_label_list *list, \
+        char *str, size_t len)
+{
+    struct mlua_map_label *label_cur;
+    uint32_t hash = (uint32_t)mlua_hash_fnv1a(str, len);
+    size_t bucket;
+
+    label_cur = list->labels[hash & (list->labels_capacity - 1)];
+    while (label_cur != NULL)
+    {
+        if ((label_cur->hash == hash) && \
+                (label_cur->len == len) && \
+                (strncmp(label_cur->str, str, len) == 0))
+        { return label_cur; }
+        label_cur = label_cur->next; 
+    }
+
+    if (list->labels_size >= list->labels_capacity)
+    {
+        if (mlua_map_offset_label_list_rehash(list) != 0) { return NULL; }
+    }
+
+    if ((label_cur = mlua_map_label_new(str, len, hash)) == NULL) { return NULL; }
+    bucket = hash & (list->labels_capacity - 1);
+    label_cur->next = list->labels[bucket];
+    list->labels[bucket] = label_cur;
+    list->labels_size++;
+
+    return label_cur;
+}
+
 int mlua_map_offset_label_list_append_with_configure( \
         struct mlua_map_offset_label_list *list, \
         uint32_t offset, \
@@ -153,10 +264,14 @@ int mlua_map_offset_label_list_append_with_configure( \
         uint32_t pos_ln, uint32_t pos_col)
 {
     struct mlua_map_offset_label *new_mlua_map_offset_label = NULL;
+    struct mlua_map_label *label;
+
+    label = mlua_map_offset_label_list_intern(list, str, len);
+    if (label == NULL) { return -1; }
 
     new_mlua_map_offset_label = mlua_map_offset_label_new( \
             offset, \
-            str, len, \
+            label, \
             pos_ln, pos_col);
     if (new_mlua_map_offset_label == NULL) { return -1; }
 
@@ -165,7 +280,29 @@ int mlua_map_offset_label_list_append_with_configure( \
     return 0;
 }
 
+int mlua_map_offset_label_list_define( \
+        struct mlua_map_offset_label_list *list, \
+        uint32_t offset, \
+        char *str, size_t len)
+{
+    struct mlua_map_label *label;
+
+    label = mlua_map_offset_label_list_intern(list, str, len);
+    if (label == NULL) { return -1; }
 
+    /* The first definition wins */
+    if (label->defined == 0)
+    {
+        label->defined = 1;
+        label->offset = offset;
+    }
+
+    return 0;
+}
+
+
+/* Patch all the gotos of a function in one pass,
+ * the targets are already resolved through the interned labels */
 int mlua_icodegen_statement_list_apply_goto(struct multiple_error *err, \
         struct mlua_icg_context *context, \
         struct mlua_icg_fcb_block *icg_fcb_block, \
@@ -173,33 +310,27 @@ int mlua_icodegen_statement_list_apply_goto(struct multiple_error *err, \
 {
     int ret = 0;
     struct mlua_map_offset_label *map_offset_label_cur;
-    struct multiply_offset_item *offset_item_target;
-    uint32_t offset_label;
-    uint32_t offset_goto;
+
+    (void)context;
 
     /* Apply goto to labels */
     map_offset_label_cur = map_offset_label_list->begin;
     while (map_offset_label_cur != NULL)
     {
-        /* Locate to the label definition */
-        offset_item_target = multiply_offset_item_pack_stack_lookup_by_label( \
-                context->offset_item_pack_stack, \
-                map_offset_label_cur->str, \
-                map_offset_label_cur->len, \
-                icg_fcb_block);
-        if (offset_item_target == NULL)
+        if (map_offset_label_cur->label->defined == 0)
         {
             multiple_error_update(err, -MULTIPLE_ERR_ICODEGEN, \
                     "%d:%d: error: label '%s' not found", \
                     map_offset_label_cur->pos_ln, map_offset_label_cur->pos_col, \
-                    map_offset_label_cur->str);
+                    map_offset_label_cur->label->str);
             ret = -MULTIPLE_ERR_ICODEGEN;
             goto fail;
         }
 
-        offset_label = offset_item_target->offset;
-        offset_goto = map_offset_label_cur->offset;
-        if ((ret = mlua_icg_fcb_block_link_relative(icg_fcb_block, offset_goto, offset_label)) != 0) { goto fail; }
+        if ((ret = mlua_icg_fcb_block_link_relative(icg_fcb_block, \
+                        map_offset_label_cur->offset, \
+                        map_offset_label_cur->label->offset)) != 0)
+        { goto fail; }
 
         map_offset_label_cur = map_offset_label_cur->next;
     }
@@ -33,14 +33,33 @@ int mlua_icg_fcb_block_append_from_precompiled_pic_text( \
         struct multiply_text_precompiled *text_precompiled);
 
 
+/* Label names of a function, interned in a hash table */
+
+#define MLUA_MAP_LABEL_TABLE_INIT_SIZE 16
+
+struct mlua_map_label
+{
+    char *str;
+    size_t len;
+    uint32_t hash;
+
+    /* Offset of the label definition */
+    int defined;
+    uint32_t offset;
+
+    struct mlua_map_label *next;
+};
+struct mlua_map_label *mlua_map_label_new(char *str, size_t len, uint32_t hash);
+int mlua_map_label_destroy(struct mlua_map_label *label);
+
 /* A data structure for connecting goto's offset and label */
 
 struct mlua_map_offset_label
 {
     uint32_t offset;
 
-    char *str;
-    size_t len;
+    /* Interned label name */
+    struct mlua_map_label *label;
 
     uint32_t pos_ln;
     uint32_t pos_col;
@@ -50,7 +69,7 @@ struct mlua_map_offset_label
 };
 struct mlua_map_offset_label *mlua_map_offset_label_new( \
         uint32_t offset, \
-        char *str, size_t len, \
+        struct mlua_map_label *label, \
         uint32_t pos_ln, uint32_t pos_col);
 int mlua_map_offset_label_destroy(struct mlua_map_offset_label *mlua_map_offset_label);
 
@@ -58,6 +77,11 @@ struct mlua_map_offset_label_list
 {
     struct mlua_map_offset_label *begin;
     struct mlua_map_offset_label *end;
+
+    /* Labels of the function */
+    struct mlua_map_label **labels;
+    size_t labels_capacity;
+    size_t labels_size;
 };
 struct mlua_map_offset_label_list *mlua_map_offset_label_list_new(void);
 int mlua_map_offset_label_list_destroy(struct mlua_map_offset_label_list *list);
@@ -68,6 +92,10 @@ int mlua_map_offset_label_list_append_with_configure( \
         uint32_t offset, \
         char *str, size_t len, \
         uint32_t pos_ln, uint32_t pos_col);
+int mlua_map_offset_label_list_define( \
+        struct mlua_map_offset_label_list *list, \
+        uint32_t offset, \
+        char *str, size_t len);
 
 int mlua_icodegen_statement_list_apply_goto(struct multiple_error *err, \
         struct mlua_icg_context *context, \
@@ -37,6 +37,8 @@
 #include "mlua_icg.h"
 #include "mlua_icg_fcb.h"
 
+#include "mlua_icg_stdlib_io.h"
+
 #include "mlua_icg_built_in_proc.h"
 
 struct mlua_icg_add_built_in_handler
@@ -51,29 +53,29 @@ struct mlua_icg_add_built_in_handler
 
 /* print() */
 /*
- * def lualst(obj)
- *     if type(obj) == type([]) then
- *         i = 0
- *         len = size(obj)
- *         first = true
- *         while i != len do
- *             if first then
- *                 first = false
- *             else
- *                 print("\t")
- *             end
- *             print(obj[i])
- *             i = i + 1
- *         end
- *     else
- *         if obj == none then
- *             print("nil")
+ * def print(...)
+ *     line = ""
+ *     for i, v in ipairs(...) do
+ *         if i ~= 1 then line = line .. "\t" end
+ *         if v == nil then line = line .. "nil"
+ *         elseif type(v) == "boolean" then line = line .. (v and "true" or "false")
+ *         elseif type(v) == "string" or type(v) == "number" then line = line .. v
  *         else
- *             print(obj)
+ *             stdout_flush(); write(line); line = ""
+ *             write(v)
  *         end
  *     end
- *     print("\n")
+ *     line = line .. "\n"
+ *     if buffering ~= "full" then write(line); return end
+ *     append(line)
+ *     if pending >= limit then stdout_flush() end
  * end
+ *
+ * The line is formatted first and written out with one OP_PRINT,
+ * nothing is pending outside "full" mode as 'io.write' and
+ * 'io.setvbuf' write out before they return. In "full" mode it is
+ * appended to the pending pieces instead. Tables and functions are
+ * left to OP_PRINT as they have no string form in the VM
  */
 static int mlua_icg_add_built_in_procs_print(
         struct multiple_error *err, \
@@ -81,83 +83,131 @@ static int mlua_icg_add_built_in_procs_print(
         struct multiply_resource_id_pool *res_id)
 {
     int ret = 0;
-    const int LBL_39 = 0, LBL_38 = 1, LBL_27 = 2;
-    const int LBL_29 = 3, LBL_16 = 4, LBL_41 = 5; 
-    const int LBL_isn_none_1 = 6, LBL_isn_none_2 = 7;
+    const int LBL_HEAD = 0, LBL_FIRST = 1, LBL_NEXT = 2;
+    const int LBL_NOT_NIL = 3, LBL_BOOLEAN = 4, LBL_TRUE = 5, LBL_NUMBER = 6;
+    const int LBL_STRING = 7, LBL_TAIL = 8, LBL_FULL = 9, LBL_DONE = 10;
 
     if ((ret = multiply_asm(err, icode, res_id, \
                     MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "obj",
-                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "obj",
-
-                    MULTIPLY_ASM_OP       , OP_TYPE    ,
-                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   ,     0,
-                    MULTIPLY_ASM_OP       , OP_TYPE    ,
-                    MULTIPLY_ASM_OP       , OP_NE      ,
-                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_39,
 
-                    MULTIPLY_ASM_OP_INT   , OP_PUSH    ,     0,
-                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "i",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    ,     "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "line",
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,  "obj",
                     MULTIPLY_ASM_OP       , OP_SIZE    ,
                     MULTIPLY_ASM_OP_ID    , OP_POP     ,  "len",
-                    MULTIPLY_ASM_OP_TRUE  , OP_PUSH    ,
-                    MULTIPLY_ASM_OP_ID    , OP_POP     ,"first",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    ,      0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "i",
 
-                    MULTIPLY_ASM_LABEL    , LBL_16     ,
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "i",
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,  "len",
-
                     MULTIPLY_ASM_OP       , OP_EQ      ,
-                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_38,
-
-                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,"first",
-                    MULTIPLY_ASM_OP       , OP_NOTL    ,
-                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_27,
-
-                    MULTIPLY_ASM_OP_FALSE , OP_PUSH    ,
-                    MULTIPLY_ASM_OP_ID    , OP_POP     ,"first",
-                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_29,
-
-                    MULTIPLY_ASM_LABEL    , LBL_27     ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    ,      0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FIRST,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "line",
                     MULTIPLY_ASM_OP_STR   , OP_PUSH    ,   "\t",
-                    MULTIPLY_ASM_OP       , OP_PRINT   ,
-                    MULTIPLY_ASM_LABEL    , LBL_29     ,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "line",
+                    MULTIPLY_ASM_LABEL    , LBL_FIRST  ,
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "i",
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,  "obj",
                     MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "v",
 
-                    MULTIPLY_ASM_OP       , OP_DUP     , 
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
                     MULTIPLY_ASM_OP_NONE  , OP_PUSH    , 
                     MULTIPLY_ASM_OP       , OP_NE      , 
-                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_isn_none_1,
-                    MULTIPLY_ASM_OP       , OP_DROP    , 
-                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "nil",
-                    MULTIPLY_ASM_LABEL    , LBL_isn_none_1,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_NIL,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    ,  "nil",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "v",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_STRING,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_NIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    ,     "",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_STRING,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    ,      0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NUMBER,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NUMBER,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_TRUE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BOOLEAN,
+
+                    /* No string form, what is before it goes out first */
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "line",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    ,     "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "line",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
                     MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_NEXT,
+
+                    MULTIPLY_ASM_LABEL    , LBL_BOOLEAN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TRUE,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "false",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "v",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_STRING,
+                    MULTIPLY_ASM_LABEL    , LBL_TRUE   ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "true",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "v",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_STRING,
+
+                    MULTIPLY_ASM_LABEL    , LBL_NUMBER ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT ,  "str",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     ,    "v",
+                    MULTIPLY_ASM_LABEL    , LBL_STRING ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "line",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "v",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "line",
 
+                    MULTIPLY_ASM_LABEL    , LBL_NEXT   ,
                     MULTIPLY_ASM_OP_ID    , OP_PUSH    ,    "i",
                     MULTIPLY_ASM_OP_INT   , OP_PUSH    ,      1,
                     MULTIPLY_ASM_OP       , OP_ADD     ,
                     MULTIPLY_ASM_OP_ID    , OP_POP     ,    "i",
-                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_16,
-                    MULTIPLY_ASM_LABEL    , LBL_38     ,
-                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_41,
-
-                    MULTIPLY_ASM_LABEL    , LBL_39     ,
-                    MULTIPLY_ASM_OP_ID    , OP_PUSH    ,  "obj",
-
-                    MULTIPLY_ASM_OP       , OP_DUP     , 
-                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    , 
-                    MULTIPLY_ASM_OP       , OP_NE      , 
-                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_isn_none_2,
-                    MULTIPLY_ASM_OP       , OP_DROP    , 
-                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "nil",
-                    MULTIPLY_ASM_LABEL    , LBL_isn_none_2,
-                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
 
-                    MULTIPLY_ASM_LABEL    , LBL_41     ,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "line",
                     MULTIPLY_ASM_OP_STR   , OP_PUSH    ,   "\n",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "line",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_MODE,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "full",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FULL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "line",
                     MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_DONE,
+                    MULTIPLY_ASM_LABEL    , LBL_FULL   ,
+                    MLUA_ICG_STDLIB_IO_ASM_APPEND("line"),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_PENDING,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_LIMIT,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
 
                     MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 0,
                     MULTIPLY_ASM_OP       , OP_RETURN  ,
@@ -291,14 +341,111 @@ done:
     return ret;
 }
 
+/* dofile(filename) */
+/*
+ * def dofile(filename)
+ *     error
+ * end
+ *
+ * Files can not be read by the virtual machine
+ */
+static int mlua_icg_add_built_in_procs_dofile(struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "filename",
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: cannot open ",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "filename",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , " (files are not supported)\n",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* load(chunk, chunkname, mode, env) */
+/*
+ * def load(chunk, chunkname, mode, env)
+ *     return nil, "..."
+ * end
+ *
+ * Chunks are compiled along with the program, only those written 
+ * as constant strings are, and their calls do not come here
+ */
+static int mlua_icg_add_built_in_procs_load(struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "only chunks written as constant strings can be loaded",
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* loadfile(filename) */
+/*
+ * def loadfile(filename)
+ *     return nil, filename .. ": files are not supported"
+ * end
+ */
+static int mlua_icg_add_built_in_procs_loadfile(struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "filename",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "filename",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , ": files are not supported",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
 /* Also check mlua_icg_fcb_built_in_proc.h */
 
-static struct mlua_icg_add_built_in_handler mlua_icg_add_built_in_handlers[] = 
+static const struct mlua_icg_add_built_in_handler mlua_icg_add_built_in_handlers[] = 
 {
     {"print", 5, mlua_icg_add_built_in_procs_print, NULL},
     {"type", 4, mlua_icg_add_built_in_procs_type, NULL},
     {"tonumber", 8, mlua_icg_add_built_in_procs_tonumber, NULL},
     {"tostring", 8, mlua_icg_add_built_in_procs_tostring, NULL},
+    {"dofile", 6, mlua_icg_add_built_in_procs_dofile, NULL},
+    {"load", 4, mlua_icg_add_built_in_procs_load, NULL},
+    {"loadfile", 8, mlua_icg_add_built_in_procs_loadfile, NULL},
+    {"loadstring", 10, mlua_icg_add_built_in_procs_load, NULL},
 };
 #define MLUA_ICG_ADD_BUILT_IN_HANDLERS_COUNT (sizeof(mlua_icg_add_built_in_handlers)/sizeof(struct mlua_icg_add_built_in_handler))
 
@@ -52,8 +52,8 @@ int mlua_icg_add_built_in_tables(struct multiple_error *err, \
     int ret = 0;
     struct mlua_icg_stdlib_table *table_cur;
     struct mlua_icg_stdlib_field *field_cur;
-    struct mlua_icg_add_built_in_table_handler *table_handler;
-    struct mlua_icg_add_built_in_field_handler *field_handler;
+    const struct mlua_icg_add_built_in_table_handler *table_handler;
+    const struct mlua_icg_add_built_in_field_handler *field_handler;
 
     uint32_t id, id_zero, id_two;
     uint32_t instrument_number;
@@ -82,6 +82,39 @@ int mlua_icg_add_built_in_tables(struct multiple_error *err, \
                         table_cur->len)) == NULL)
         { continue; }
 
+        /* Shared procedures go to hidden globals before the fields use them */
+        if (table_handler->hidden_handler != NULL)
+        {
+            for (field_handler = table_handler->hidden_handler; \
+                    field_handler->name != NULL; field_handler++)
+            {
+                instrument_number = (uint32_t)(icode->text_section->size);
+
+                if ((ret = field_handler->func(err, \
+                                icode, \
+                                res_id)) != 0)
+                { goto fail; }
+
+                if ((ret = multiply_resource_get_id( \
+                                err, \
+                                icode, \
+                                res_id, \
+                                &id,  \
+                                field_handler->name, \
+                                field_handler->name_len)) != 0)
+                { goto fail; }
+                if ((ret = mlua_icg_fcb_block_insert_with_configure_type( \
+                                icg_fcb_block_init, \
+                                insert_point++, \
+                                OP_LAMBDAMK, instrument_number, \
+                                MLUA_ICG_FCB_LINE_TYPE_BLTIN_PROC_MK)) != 0) { goto fail; }
+                if ((ret = mlua_icg_fcb_block_insert_with_configure( \
+                                icg_fcb_block_init, insert_point++, \
+                                OP_POPG, id)) != 0) { goto fail; }
+                (*instrument_count) += 2;
+            }
+        }
+
         hash_item_count_in_table = 0;
 
         for (field_cur = table_cur->fields->begin; field_cur != NULL; field_cur = field_cur->next)
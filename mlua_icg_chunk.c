@@ -0,0 +1,149 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Chunk Cache
+ * Copyright(C) 2014 Cheryl Natsu
+
+ * This file is part of multiple - Multiple Paradigm Language Interpreter
+
+ * multiple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * multiple is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#include "selfcheck.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_err.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_parser.h"
+#include "mlua_hash.h"
+#include "mlua_icg_chunk.h"
+
+/* The chunk is parsed as the body of 'function(...)', 
+ * on the first line so positions of errors keep their line */
+#define MLUA_ICG_CHUNK_HEAD "return function(...) "
+#define MLUA_ICG_CHUNK_TAIL "\nend"
+
+static void mlua_icg_chunk_destroy(struct mlua_icg_chunk *chunk)
+{
+    if (chunk->program != NULL) mlua_ast_program_destroy(chunk->program);
+    if (chunk->source != NULL) free(chunk->source);
+    free(chunk);
+}
+
+struct mlua_icg_chunk_map *mlua_icg_chunk_map_new(void)
+{
+    struct mlua_icg_chunk_map *new_map = NULL;
+    size_t idx;
+
+    new_map = (struct mlua_icg_chunk_map *)malloc(sizeof(struct mlua_icg_chunk_map));
+    if (new_map == NULL) { return NULL; }
+    for (idx = 0; idx != MLUA_ICG_CHUNK_MAP_BUCKETS; idx++)
+    { new_map->buckets[idx] = NULL; }
+
+    return new_map;
+}
+
+int mlua_icg_chunk_map_destroy(struct mlua_icg_chunk_map *map)
+{
+    struct mlua_icg_chunk *chunk_cur, *chunk_next;
+    size_t idx;
+
+    for (idx = 0; idx != MLUA_ICG_CHUNK_MAP_BUCKETS; idx++)
+    {
+        chunk_cur = map->buckets[idx];
+        while (chunk_cur != NULL)
+        {
+            chunk_next = chunk_cur->next;
+            mlua_icg_chunk_destroy(chunk_cur);
+            chunk_cur = chunk_next;
+        }
+    }
+    free(map);
+
+    return 0;
+}
+
+struct mlua_icg_chunk *mlua_icg_chunk_map_lookup(struct mlua_icg_chunk_map *map, \
+        const char *source, size_t source_len)
+{
+    uint64_t hash = mlua_hash_fnv1a(source, source_len);
+    struct mlua_icg_chunk *chunk_cur;
+
+    for (chunk_cur = map->buckets[hash % MLUA_ICG_CHUNK_MAP_BUCKETS]; \
+            chunk_cur != NULL; chunk_cur = chunk_cur->next)
+    {
+        if ((chunk_cur->hash == hash) && \
+                (chunk_cur->source_len == source_len) && \
+                (memcmp(chunk_cur->source, source, source_len) == 0))
+        { return chunk_cur; }
+    }
+
+    return NULL;
+}
+
+int mlua_icg_chunk_map_parse(struct multiple_error *err, \
+        struct mlua_icg_chunk_map *map, \
+        struct mlua_icg_chunk **chunk_out, \
+        const char *source, size_t source_len)
+{
+    int ret = 0;
+    struct mlua_icg_chunk *new_chunk = NULL;
+    struct mlua_icg_chunk **bucket;
+    char *text = NULL;
+    struct mlua_token_stream *stream = NULL;
+    size_t head_len = strlen(MLUA_ICG_CHUNK_HEAD);
+    size_t tail_len = strlen(MLUA_ICG_CHUNK_TAIL);
+
+    new_chunk = (struct mlua_icg_chunk *)malloc(sizeof(struct mlua_icg_chunk));
+    if (new_chunk == NULL) { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    new_chunk->program = NULL;
+    new_chunk->generated = 0;
+    new_chunk->block_index = 0;
+    new_chunk->next = NULL;
+    new_chunk->source = (char *)malloc(sizeof(char) * (source_len + 1));
+    if (new_chunk->source == NULL) { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    memcpy(new_chunk->source, source, source_len);
+    new_chunk->source[source_len] = '\0';
+    new_chunk->source_len = source_len;
+    new_chunk->hash = mlua_hash_fnv1a(source, source_len);
+
+    text = (char *)malloc(sizeof(char) * (head_len + source_len + tail_len));
+    if (text == NULL) { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    memcpy(text, MLUA_ICG_CHUNK_HEAD, head_len);
+    memcpy(text + head_len, source, source_len);
+    memcpy(text + head_len + source_len, MLUA_ICG_CHUNK_TAIL, tail_len);
+
+    if ((ret = mlua_token_stream_new_from_memory(err, &stream, \
+                    text, head_len + source_len + tail_len)) != 0)
+    { goto fail; }
+    if ((ret = mlua_parse_stream(err, &new_chunk->program, stream)) != 0)
+    { goto fail; }
+
+    bucket = &map->buckets[new_chunk->hash % MLUA_ICG_CHUNK_MAP_BUCKETS];
+    new_chunk->next = *bucket;
+    *bucket = new_chunk;
+    *chunk_out = new_chunk;
+    new_chunk = NULL;
+
+    goto done;
+fail:
+done:
+    if (stream != NULL) mlua_token_stream_destroy(stream);
+    if (text != NULL) free(text);
+    if (new_chunk != NULL) mlua_icg_chunk_destroy(new_chunk);
+    return ret;
+}
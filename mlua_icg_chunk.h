@@ -0,0 +1,72 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Chunk Cache
+ * Copyright(C) 2014 Cheryl Natsu
+
+ * This file is part of multiple - Multiple Paradigm Language Interpreter
+
+ * multiple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * multiple is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#ifndef _MLUA_ICG_CHUNK_H_
+#define _MLUA_ICG_CHUNK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "multiple_err.h"
+#include "mlua_ast.h"
+
+#define MLUA_ICG_CHUNK_MAP_BUCKETS 64
+
+/* Source of a chunk given to 'load' and the function block 
+ * it was generated into, every site loading the same source 
+ * takes the closure made of that block */
+struct mlua_icg_chunk
+{
+    char *source;
+    size_t source_len;
+    uint64_t hash;
+
+    /* Parsed before the program is generated, so the names the 
+     * chunk binds are known to every call site */
+    struct mlua_ast_program *program;
+
+    /* Set once the block is generated */
+    int generated;
+    /* Operand of OP_LAMBDAMK */
+    uint32_t block_index;
+
+    /* Same bucket */
+    struct mlua_icg_chunk *next;
+};
+
+/* Chunks by their source, kept until the program is generated */
+struct mlua_icg_chunk_map
+{
+    struct mlua_icg_chunk *buckets[MLUA_ICG_CHUNK_MAP_BUCKETS];
+};
+
+struct mlua_icg_chunk_map *mlua_icg_chunk_map_new(void);
+int mlua_icg_chunk_map_destroy(struct mlua_icg_chunk_map *map);
+/* NULL when missing */
+struct mlua_icg_chunk *mlua_icg_chunk_map_lookup(struct mlua_icg_chunk_map *map, \
+        const char *source, size_t source_len);
+/* Parse 'source' as the body of 'function(...)' and keep it */
+int mlua_icg_chunk_map_parse(struct multiple_error *err, \
+        struct mlua_icg_chunk_map *map, \
+        struct mlua_icg_chunk **chunk_out, \
+        const char *source, size_t source_len);
+
+#endif
+
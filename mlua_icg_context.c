@@ -23,24 +23,54 @@
 #include <string.h>
 
 #include "multiple_ir.h"
+#include "multiply.h"
+#include "multiply_assembler.h"
 
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_context.h"
+#include "mlua_icg_inline.h"
 
 int mlua_icg_context_init(struct mlua_icg_context *context)
 {
+    int idx;
+
     context->icg_fcb_block_list = NULL;
     context->icode = NULL;
     context->res_id = NULL;
     context->customizable_built_in_procedure_list = NULL;
     context->offset_item_pack_stack = NULL;
     context->stdlibs = NULL;
+    context->chunks = NULL;
+    context->inline_bindings = NULL;
+    context->icg_fcb_block_autorun = NULL;
+    context->icg_fcb_block_chunks = NULL;
+    for (idx = 0; idx != MLUA_ICG_TEMPLATE_COUNT; idx++)
+    { context->templates[idx] = NULL; }
     return 0;
 }
 
 int mlua_icg_context_uninit(struct mlua_icg_context *context)
 {
-    (void)context;
+    int idx;
+
+    for (idx = 0; idx != MLUA_ICG_TEMPLATE_COUNT; idx++)
+    {
+        if (context->templates[idx] != NULL)
+        {
+            multiply_text_precompiled_destroy(context->templates[idx]);
+            context->templates[idx] = NULL;
+        }
+    }
+    if (context->chunks != NULL)
+    {
+        mlua_icg_chunk_map_destroy(context->chunks);
+        context->chunks = NULL;
+    }
+    if (context->inline_bindings != NULL)
+    {
+        mlua_icg_inline_bindings_destroy(context->inline_bindings);
+        context->inline_bindings = NULL;
+    }
     return 0;
 }
 
@@ -24,10 +24,38 @@
 #include "multiple_ir.h"
 
 #include "multiply.h"
+#include "multiply_assembler.h"
 
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_built_in_proc.h"
 #include "mlua_icg_stdlib.h"
+#include "mlua_icg_chunk.h"
+
+struct mlua_icg_inline_bindings;
+
+/* Asm templates precompiled once per context and
+ * copied into the blocks at every site that uses them */
+enum
+{
+    MLUA_ICG_TEMPLATE_PREFIX_VAR = 0,
+    MLUA_ICG_TEMPLATE_SUFFIXED,
+    MLUA_ICG_TEMPLATE_FUNCALL,
+    MLUA_ICG_TEMPLATE_PRIMARY_NAME,
+    MLUA_ICG_TEMPLATE_DIV,
+    MLUA_ICG_TEMPLATE_MOD,
+    MLUA_ICG_TEMPLATE_FIX_EXPLIST,
+    MLUA_ICG_TEMPLATE_EXPLIST_LAST,
+    MLUA_ICG_TEMPLATE_EXPLIST_NOT_LAST,
+    MLUA_ICG_TEMPLATE_TRIM_EXPLIST,
+    MLUA_ICG_TEMPLATE_PARLIST_ARG,
+    MLUA_ICG_TEMPLATE_PARLIST_REST,
+    MLUA_ICG_TEMPLATE_PARLIST_NORMAL,
+    MLUA_ICG_TEMPLATE_ASSIGN_NAME,
+    MLUA_ICG_TEMPLATE_ASSIGN_SUFFIXED,
+    MLUA_ICG_TEMPLATE_IO_INIT,
+    MLUA_ICG_TEMPLATE_IO_FLUSH,
+    MLUA_ICG_TEMPLATE_COUNT
+};
 
 struct mlua_icg_context
 {
@@ -37,6 +65,16 @@ struct mlua_icg_context
     struct mlua_icg_customizable_built_in_procedure_list *customizable_built_in_procedure_list;
     struct multiply_offset_item_pack_stack *offset_item_pack_stack;
     struct mlua_icg_stdlib_table_list *stdlibs;
+    struct multiply_text_precompiled *templates[MLUA_ICG_TEMPLATE_COUNT];
+    /* Chunks of 'load' generated at compile time, created on the first use */
+    struct mlua_icg_chunk_map *chunks;
+    /* Names the inline handlers must not take for the standard library */
+    struct mlua_icg_inline_bindings *inline_bindings;
+    /* Block of the main chunk, a 'return' in it ends the program */
+    struct mlua_icg_fcb_block *icg_fcb_block_autorun;
+    /* Closures of the chunks given to 'load', made by a function of 
+     * their own that '__autorun__' calls before the program runs */
+    struct mlua_icg_fcb_block *icg_fcb_block_chunks;
 };
 
 int mlua_icg_context_init(struct mlua_icg_context *context);
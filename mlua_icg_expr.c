@@ -43,6 +43,7 @@
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_context.h"
 #include "mlua_icg_aux.h"
+#include "mlua_icg_inline.h"
 
 #include "mlua_icg_expr.h"
 #include "mlua_icg_stmt.h"
@@ -104,6 +105,7 @@ int mlua_icodegen_args(struct multiple_error *err, \
                             1)) != 0)
             { goto fail; }
             if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id)) != 0) 
+            { goto fail; }
 
             break;
 
@@ -143,7 +145,8 @@ static int mlua_icodegen_expression_prefix(struct multiple_error *err, \
         struct mlua_ast_expression_prefix *exp_prefix)
 {
     int ret = 0;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    uint32_t id;
+    uint32_t instrument_number;
 
     switch (exp_prefix->type)
     {
@@ -155,24 +158,39 @@ static int mlua_icodegen_expression_prefix(struct multiple_error *err, \
                             exp_prefix->u.var->len)) != 0)
             { goto fail; }
 
-            if ((ret = multiply_asm_precompile(err, \
+            if ((context->templates[MLUA_ICG_TEMPLATE_PREFIX_VAR] == NULL) && \
+                    ((ret = multiply_asm_precompile(err, \
                             context->icode, \
                             context->res_id, \
-                            &new_text_precompiled, \
+                            &context->templates[MLUA_ICG_TEMPLATE_PREFIX_VAR], \
 
                             MULTIPLY_ASM_OP_INT , OP_PUSH    , 1          , 
-                            MULTIPLY_ASM_OP_ID  , OP_PUSH    , exp_prefix->u.var->str,
+                            MULTIPLY_ASM_OP_RAW , OP_PUSH    , 0          ,
                             MULTIPLY_ASM_OP     , OP_SLV     , 
                             MULTIPLY_ASM_OP     , OP_FUNCMK  , 
                             MULTIPLY_ASM_OP     , OP_CALLC   , 
                             MULTIPLY_ASM_OP     , OP_DROP    , 
 
-                            MULTIPLY_ASM_FINISH)) != 0)
+                            MULTIPLY_ASM_FINISH)) != 0))
             { goto fail; }
 
+            if ((ret = multiply_resource_get_id( \
+                            err, \
+                            context->icode, \
+                            context->res_id, \
+                            &id, \
+                            exp_prefix->u.var->str, \
+                            exp_prefix->u.var->len)) != 0)
+            { goto fail; }
+
+            instrument_number = mlua_icg_fcb_block_get_instrument_number(icg_fcb_block);
             if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                             icg_fcb_block, \
-                            new_text_precompiled)) != 0)
+                            context->templates[MLUA_ICG_TEMPLATE_PREFIX_VAR])) != 0)
+            { goto fail; }
+            /* Name of the variable */
+            if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                            instrument_number + 1, id)) != 0)
             { goto fail; }
 
             break;
@@ -188,20 +206,46 @@ static int mlua_icodegen_expression_prefix(struct multiple_error *err, \
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
 
+/* 'table.field' of a member of a named table, 
+ * the name is not terminated, 0 when it fits */
+static int mlua_icodegen_expression_suffixed_member_name( \
+        char *name, size_t *name_len_out, \
+        struct mlua_ast_expression_suffixed *exp_suffixed)
+{
+    struct token *table_name, *field_name;
+    size_t name_len;
+
+    if ((exp_suffixed->type != MLUA_AST_EXPRESSION_SUFFIXED_TYPE_MEMBER) || \
+            (exp_suffixed->sub->type != MLUA_AST_EXPRESSION_TYPE_PRIMARY) || \
+            (exp_suffixed->sub->u.primary->type != MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME))
+    { return -1; }
+
+    table_name = exp_suffixed->sub->u.primary->u.name;
+    field_name = exp_suffixed->u.name;
+    name_len = table_name->len + 1 + field_name->len;
+    if (name_len > MLUA_ICG_INLINE_NAME_LEN_MAX) return -1;
+    memcpy(name, table_name->str, table_name->len);
+    name[table_name->len] = '.';
+    memcpy(name + table_name->len + 1, field_name->str, field_name->len);
+    *name_len_out = name_len;
+
+    return 0;
+}
+
 static int mlua_icodegen_expression_suffixed(struct multiple_error *err, \
         struct mlua_icg_context *context, \
         struct mlua_icg_fcb_block *icg_fcb_block, \
         struct mlua_ast_expression_suffixed *exp_suffixed)
 {
     int ret = 0;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
     uint32_t id;
+    const struct mlua_icg_inline_constant *inline_constant;
+    char name[MLUA_ICG_INLINE_NAME_LEN_MAX];
+    size_t name_len;
     const int LBL_HASKEY = 0, LBL_TAIL = 1;
 
     switch (exp_suffixed->type)
@@ -228,6 +272,15 @@ static int mlua_icodegen_expression_suffixed(struct multiple_error *err, \
 
         case MLUA_AST_EXPRESSION_SUFFIXED_TYPE_MEMBER:
 
+            /* Constants of the standard library, like 'math.pi' */
+            if ((mlua_icodegen_expression_suffixed_member_name(name, &name_len, exp_suffixed) == 0) && \
+                    (mlua_icg_inline_bindings_bound(context->inline_bindings, name, name_len) == 0) && \
+                    ((inline_constant = mlua_icg_inline_constant_lookup(name, name_len)) != NULL))
+            {
+                ret = inline_constant->func(err, context, icg_fcb_block);
+                goto done;
+            }
+
             /* Standard Library */
             if (exp_suffixed->sub->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY)
             {
@@ -276,10 +329,11 @@ static int mlua_icodegen_expression_suffixed(struct multiple_error *err, \
 
     /* Can not just simply get the member but test it if exist */
 
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_SUFFIXED] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled, \
+                    &context->templates[MLUA_ICG_TEMPLATE_SUFFIXED], \
 
                     /* State : <bottom> index, hash <top> */
                     MULTIPLY_ASM_OP_INT , OP_PUSH    , 2          , 
@@ -303,30 +357,69 @@ static int mlua_icodegen_expression_suffixed(struct multiple_error *err, \
 
                     MULTIPLY_ASM_LABEL  , LBL_TAIL   , 
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
     { goto fail; }
 
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled)) != 0)
+                    context->templates[MLUA_ICG_TEMPLATE_SUFFIXED])) != 0)
     { goto fail; }
 
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
 
+/* Handler of calls like 'string.format(...)' or 'load(...)', 
+ * unless the program binds the name itself */
+static const struct mlua_icg_inline_handler *mlua_icodegen_expression_funcall_inline_handler( \
+        struct mlua_icg_context *context, \
+        struct mlua_ast_expression_funcall *exp_funcall)
+{
+    char name[MLUA_ICG_INLINE_NAME_LEN_MAX];
+    size_t name_len;
+    struct mlua_ast_expression_primary *exp_primary;
+
+    if (exp_funcall->prefixexp->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY)
+    {
+        exp_primary = exp_funcall->prefixexp->u.primary;
+        if (exp_primary->type != MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME) return NULL;
+        if (mlua_icg_inline_bindings_bound(context->inline_bindings, \
+                    exp_primary->u.name->str, exp_primary->u.name->len) != 0)
+        { return NULL; }
+        return mlua_icg_inline_handler_lookup(exp_primary->u.name->str, exp_primary->u.name->len);
+    }
+
+    if (exp_funcall->prefixexp->type != MLUA_AST_EXPRESSION_TYPE_SUFFIXED) return NULL;
+    if (mlua_icodegen_expression_suffixed_member_name(name, &name_len, \
+                exp_funcall->prefixexp->u.suffixed) != 0)
+    { return NULL; }
+    if (mlua_icg_inline_bindings_bound(context->inline_bindings, name, name_len) != 0)
+    { return NULL; }
+
+    return mlua_icg_inline_handler_lookup(name, name_len);
+}
+
 int mlua_icodegen_expression_funcall(struct multiple_error *err, \
         struct mlua_icg_context *context, \
         struct mlua_icg_fcb_block *icg_fcb_block, \
         struct mlua_ast_expression_funcall *exp_funcall)
 {
     int ret = 0;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    const struct mlua_icg_inline_handler *inline_handler;
+
+    /* Standard library functions generated in place */
+    if ((inline_handler = mlua_icodegen_expression_funcall_inline_handler(context, exp_funcall)) != NULL)
+    {
+        ret = inline_handler->func(err, \
+                context, \
+                icg_fcb_block, \
+                exp_funcall->args);
+        if (ret != MLUA_ICG_INLINE_DECLINED) { goto done; }
+        ret = 0;
+    }
 
     /* Arguments */
     if ((ret = mlua_icodegen_args(err, \
@@ -343,28 +436,27 @@ int mlua_icodegen_expression_funcall(struct multiple_error *err, \
     { goto fail; }
 
     /* Call */
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_FUNCALL] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled, \
+                    &context->templates[MLUA_ICG_TEMPLATE_FUNCALL], \
 
                     MULTIPLY_ASM_OP     , OP_FUNCMK  , 
                     MULTIPLY_ASM_OP     , OP_CALLC   , 
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
     { goto fail; }
 
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled)) != 0)
+                    context->templates[MLUA_ICG_TEMPLATE_FUNCALL])) != 0)
     { goto fail; }
 
 
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -720,7 +812,7 @@ static int mlua_icodegen_expression_primary(struct multiple_error *err, \
 {
     int ret = 0;
     uint32_t id;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    uint32_t instrument_number;
     const int LBL_HAS_VAR = 0, LBL_TAIL = 1;
 
     switch (exp_primary->type)
@@ -736,13 +828,14 @@ static int mlua_icodegen_expression_primary(struct multiple_error *err, \
                             exp_primary->u.name->len)) != 0)
             { goto fail; }
 
-            if ((ret = multiply_asm_precompile(err, \
+            if ((context->templates[MLUA_ICG_TEMPLATE_PRIMARY_NAME] == NULL) && \
+                    ((ret = multiply_asm_precompile(err, \
                             context->icode, \
                             context->res_id, \
-                            &new_text_precompiled, \
+                            &context->templates[MLUA_ICG_TEMPLATE_PRIMARY_NAME], \
 
                             /* if (var exists) goto lbl_hasvar; */
-                            MULTIPLY_ASM_OP_RAW , OP_PUSH    , id, 
+                            MULTIPLY_ASM_OP_RAW , OP_PUSH    , 0, 
                             MULTIPLY_ASM_OP     , OP_TRYSLV  , 
                             MULTIPLY_ASM_OP_LBLR, OP_JMPCR   , LBL_HAS_VAR,
 
@@ -753,16 +846,25 @@ static int mlua_icodegen_expression_primary(struct multiple_error *err, \
 
                             /* lbl_hasvar: */
                             MULTIPLY_ASM_LABEL  , LBL_HAS_VAR ,
-                            MULTIPLY_ASM_OP_RAW , OP_PUSH    , id, 
+                            MULTIPLY_ASM_OP_RAW , OP_PUSH    , 0, 
 
                             /* lbl_tail: */
                             MULTIPLY_ASM_LABEL  , LBL_TAIL ,
 
-                            MULTIPLY_ASM_FINISH)) != 0)
+                            MULTIPLY_ASM_FINISH)) != 0))
             { goto fail; }
+
+            instrument_number = mlua_icg_fcb_block_get_instrument_number(icg_fcb_block);
             if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                             icg_fcb_block, \
-                            new_text_precompiled)) != 0)
+                            context->templates[MLUA_ICG_TEMPLATE_PRIMARY_NAME])) != 0)
+            { goto fail; }
+            /* Name of the variable at both pushes */
+            if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                            instrument_number + 0, id)) != 0)
+            { goto fail; }
+            if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                            instrument_number + 5, id)) != 0)
             { goto fail; }
 
 
@@ -792,8 +894,6 @@ static int mlua_icodegen_expression_primary(struct multiple_error *err, \
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -1027,15 +1127,17 @@ static int mlua_icodegen_expression_binop_div_mod(struct multiple_error *err, \
     int ret = 0;
     uint32_t op = 0;
     const int LBL_RIGHT_ZERO = 0, LBL_LEFT_ZERO = 1, LBL_TAIL = 2; 
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    int template_id = 0;
 
     switch (exp_binop->op->value)
     {
         case '/':
             op = OP_DIV;
+            template_id = MLUA_ICG_TEMPLATE_DIV;
             break;
         case '%':
             op = OP_MOD;
+            template_id = MLUA_ICG_TEMPLATE_MOD;
             break;
         default:
             MULTIPLE_ERROR_INTERNAL();
@@ -1072,10 +1174,11 @@ static int mlua_icodegen_expression_binop_div_mod(struct multiple_error *err, \
     if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_TYPEUP, 0)) != 0) 
     { goto fail; }
 
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[template_id] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled, \
+                    &context->templates[template_id], \
 
                     /* <bottom> left, right <top> */
                     MULTIPLY_ASM_OP      , OP_DUP       , 
@@ -1131,19 +1234,17 @@ static int mlua_icodegen_expression_binop_div_mod(struct multiple_error *err, \
                     /* tail: */
                     MULTIPLY_ASM_LABEL   , LBL_TAIL,
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
     { goto fail; }
 
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled)) != 0)
+                    context->templates[template_id])) != 0)
     { goto fail; }
 
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -1498,15 +1599,15 @@ int mlua_icodegen_expression_fix_explist(struct multiple_error *err, \
         struct mlua_icg_fcb_block *icg_fcb_block)
 {
     int ret = 0;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
     const int LBL_NOT_LIST = 0;
     const int LBL_ZERO_SIZE = 1;
     const int LBL_TAIL = 2;
 
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_FIX_EXPLIST] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled, \
+                    &context->templates[MLUA_ICG_TEMPLATE_FIX_EXPLIST], \
 
                     /* Solve it */
                     MULTIPLY_ASM_OP     , OP_SLV      , 
@@ -1544,19 +1645,17 @@ int mlua_icodegen_expression_fix_explist(struct multiple_error *err, \
                     /* lbl_zero_size: */
                     MULTIPLY_ASM_LABEL  , LBL_TAIL,
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
     { goto fail; }
 
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled)) != 0)
+                    context->templates[MLUA_ICG_TEMPLATE_FIX_EXPLIST])) != 0)
     { goto fail; }
 
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -122,7 +122,6 @@ struct mlua_icg_fcb_line *mlua_icg_fcb_line_new(void)
     new_icg_fcb_line->opcode = new_icg_fcb_line->operand = 0;
     new_icg_fcb_line->type = MLUA_ICG_FCB_LINE_TYPE_NORMAL;
     new_icg_fcb_line->attrs = NULL;
-    new_icg_fcb_line->prev = new_icg_fcb_line->next = NULL;
     goto done;
 fail:
     if (new_icg_fcb_line != NULL) { free(new_icg_fcb_line); new_icg_fcb_line = NULL; }
@@ -181,9 +180,10 @@ struct mlua_icg_fcb_block *mlua_icg_fcb_block_new(void)
 
     new_icg_fcb_block = (struct mlua_icg_fcb_block *)malloc(sizeof(struct mlua_icg_fcb_block));
     if (new_icg_fcb_block == NULL) goto fail;
-    new_icg_fcb_block->begin = new_icg_fcb_block->end = NULL;
+    new_icg_fcb_block->lines = NULL;
     new_icg_fcb_block->prev = new_icg_fcb_block->next = NULL;
     new_icg_fcb_block->size = 0;
+    new_icg_fcb_block->capacity = 0;
     goto done;
 fail:
     if (new_icg_fcb_block != NULL) { free(new_icg_fcb_block); }
@@ -193,36 +193,70 @@ done:
 
 int mlua_icg_fcb_block_destroy(struct mlua_icg_fcb_block *icg_fcb_block)
 {
-    struct mlua_icg_fcb_line *icg_fcb_line_cur, *icg_fcb_line_next;
+    size_t idx;
 
     if (icg_fcb_block == NULL) return -MULTIPLE_ERR_NULL_PTR;
-    icg_fcb_line_cur = icg_fcb_block->begin;
-    while (icg_fcb_line_cur != NULL)
+    for (idx = 0; idx != icg_fcb_block->size; idx++)
     {
-        icg_fcb_line_next = icg_fcb_line_cur->next; 
-        mlua_icg_fcb_line_destroy(icg_fcb_line_cur);
-        icg_fcb_line_cur = icg_fcb_line_next;
+        mlua_icg_fcb_line_destroy(icg_fcb_block->lines[idx]);
     }
+    if (icg_fcb_block->lines != NULL) free(icg_fcb_block->lines);
     free(icg_fcb_block); 
     return 0;
 }
 
+/* Make room for at least 'size' lines */
+static int mlua_icg_fcb_block_reserve(struct mlua_icg_fcb_block *icg_fcb_block, \
+        size_t size)
+{
+    struct mlua_icg_fcb_line **new_lines;
+    size_t new_capacity;
+
+    if (size <= icg_fcb_block->capacity) return 0;
+
+    new_capacity = (icg_fcb_block->capacity == 0) ? MLUA_ICG_FCB_BLOCK_INIT_CAPACITY : icg_fcb_block->capacity;
+    while (new_capacity < size) new_capacity *= 2;
+
+    new_lines = (struct mlua_icg_fcb_line **)realloc(icg_fcb_block->lines, \
+            sizeof(struct mlua_icg_fcb_line *) * new_capacity);
+    if (new_lines == NULL) return -MULTIPLE_ERR_MALLOC;
+    icg_fcb_block->lines = new_lines;
+    icg_fcb_block->capacity = new_capacity;
+
+    return 0;
+}
+
+/* Lines of type PC pointing after the insert point move along */
+static void mlua_icg_fcb_block_fix_pc(struct mlua_icg_fcb_block *icg_fcb_block, \
+        uint32_t instrument_number_insert, uint32_t count)
+{
+    struct mlua_icg_fcb_line *icg_fcb_line_cur;
+    size_t idx;
+
+    for (idx = 0; idx != icg_fcb_block->size; idx++)
+    {
+        icg_fcb_line_cur = icg_fcb_block->lines[idx];
+        if (icg_fcb_line_cur->type == MLUA_ICG_FCB_LINE_TYPE_PC)
+        {
+            if (icg_fcb_line_cur->operand > instrument_number_insert)
+            {
+                icg_fcb_line_cur->operand += count;
+            }
+        }
+    }
+}
+
 int mlua_icg_fcb_block_append(struct mlua_icg_fcb_block *icg_fcb_block, \
         struct mlua_icg_fcb_line *new_icg_fcb_line)
 {
+    int ret;
+
     if (icg_fcb_block == NULL) return -MULTIPLE_ERR_NULL_PTR;
     if (new_icg_fcb_line == NULL) return -MULTIPLE_ERR_NULL_PTR;
 
-    if (icg_fcb_block->begin == NULL)
-    {
-        icg_fcb_block->begin = icg_fcb_block->end = new_icg_fcb_line;
-    }
-    else
-    {
-        icg_fcb_block->end->next = new_icg_fcb_line;
-        new_icg_fcb_line->prev = icg_fcb_block->end;
-        icg_fcb_block->end = new_icg_fcb_line;
-    }
+    if ((ret = mlua_icg_fcb_block_reserve(icg_fcb_block, icg_fcb_block->size + 1)) != 0)
+    { return ret; }
+    icg_fcb_block->lines[icg_fcb_block->size] = new_icg_fcb_line;
     icg_fcb_block->size += 1;
 
     return 0;
@@ -232,48 +266,54 @@ int mlua_icg_fcb_block_insert(struct mlua_icg_fcb_block *icg_fcb_block, \
         uint32_t instrument_number_insert, \
         struct mlua_icg_fcb_line *new_icg_fcb_line)
 {
-    struct mlua_icg_fcb_line *icg_fcb_line_cur = NULL, *icg_fcb_line_prev = NULL;
-    uint32_t instrument_number = instrument_number_insert;
+    int ret;
 
-    /* Locate to the position */
-    icg_fcb_line_cur = icg_fcb_block->begin;
-    while ((icg_fcb_line_cur != NULL) && (instrument_number-- != 0))
-    {
-        icg_fcb_line_prev = icg_fcb_line_cur;
-        icg_fcb_line_cur = icg_fcb_line_cur->next; 
-    }
+    if (instrument_number_insert > icg_fcb_block->size) { return -MULTIPLE_ERR_INTERNAL; }
 
-    if (icg_fcb_line_cur == NULL) { return -MULTIPLE_ERR_INTERNAL; }
+    if ((ret = mlua_icg_fcb_block_reserve(icg_fcb_block, icg_fcb_block->size + 1)) != 0)
+    { return ret; }
 
     /* Insert */
-    if (icg_fcb_line_prev == NULL)
-    {
-        new_icg_fcb_line->next = icg_fcb_block->begin;
-        icg_fcb_block->begin->prev = new_icg_fcb_line;
-        icg_fcb_block->begin = new_icg_fcb_line;
-    }
-    else
-    {
-        icg_fcb_line_prev->next = new_icg_fcb_line;
-        new_icg_fcb_line->prev = icg_fcb_line_prev;
-        new_icg_fcb_line->next = icg_fcb_line_cur;
-        icg_fcb_line_cur->prev = new_icg_fcb_line;
-    }
+    memmove(icg_fcb_block->lines + instrument_number_insert + 1, \
+            icg_fcb_block->lines + instrument_number_insert, \
+            sizeof(struct mlua_icg_fcb_line *) * (icg_fcb_block->size - instrument_number_insert));
+    icg_fcb_block->lines[instrument_number_insert] = new_icg_fcb_line;
     icg_fcb_block->size += 1;
 
     /* Fix */
-    icg_fcb_line_cur = icg_fcb_block->begin;
-    while (icg_fcb_line_cur != NULL)
-    {
-        if (icg_fcb_line_cur->type == MLUA_ICG_FCB_LINE_TYPE_PC)
-        {
-            if (icg_fcb_line_cur->operand > instrument_number_insert)
-            {
-                icg_fcb_line_cur->operand += 1;
-            }
-        }
-        icg_fcb_line_cur = icg_fcb_line_cur->next;
-    }
+    mlua_icg_fcb_block_fix_pc(icg_fcb_block, instrument_number_insert, 1);
+
+    return 0;
+}
+
+int mlua_icg_fcb_block_insert_block(struct mlua_icg_fcb_block *icg_fcb_block, \
+        uint32_t instrument_number_insert, \
+        struct mlua_icg_fcb_block *icg_fcb_block_src)
+{
+    int ret;
+    size_t count = icg_fcb_block_src->size;
+
+    if (instrument_number_insert > icg_fcb_block->size) { return -MULTIPLE_ERR_INTERNAL; }
+    if (count == 0) return 0;
+
+    if ((ret = mlua_icg_fcb_block_reserve(icg_fcb_block, icg_fcb_block->size + count)) != 0)
+    { return ret; }
+
+    /* Fix before the lines move in, 
+     * same as inserting them one by one at increasing positions */
+    mlua_icg_fcb_block_fix_pc(icg_fcb_block, instrument_number_insert, (uint32_t)count);
+
+    /* Insert */
+    memmove(icg_fcb_block->lines + instrument_number_insert + count, \
+            icg_fcb_block->lines + instrument_number_insert, \
+            sizeof(struct mlua_icg_fcb_line *) * (icg_fcb_block->size - instrument_number_insert));
+    memcpy(icg_fcb_block->lines + instrument_number_insert, \
+            icg_fcb_block_src->lines, \
+            sizeof(struct mlua_icg_fcb_line *) * count);
+    icg_fcb_block->size += count;
+
+    /* Lines are owned by the destination now */
+    icg_fcb_block_src->size = 0;
 
     return 0;
 }
@@ -381,45 +421,22 @@ int mlua_icg_fcb_block_insert_with_configure_type(struct mlua_icg_fcb_block *icg
 int mlua_icg_fcb_block_link(struct mlua_icg_fcb_block *icg_fcb_block, \
         uint32_t instrument_number_from, uint32_t instrument_number_to)
 {
-    struct mlua_icg_fcb_line *icg_fcb_line_cur;
-    icg_fcb_line_cur = icg_fcb_block->begin;
-    while ((instrument_number_from != 0) && (icg_fcb_line_cur != NULL))
-    {
-        icg_fcb_line_cur = icg_fcb_line_cur->next; 
-        instrument_number_from -= 1;
-    }
-    if (icg_fcb_line_cur != NULL) 
-    {
-        icg_fcb_line_cur->operand = instrument_number_to;
-        return 0;
-    }
-    else
-    {
-        return -1;
-    }
+    if (instrument_number_from >= icg_fcb_block->size) return -1;
+
+    icg_fcb_block->lines[instrument_number_from]->operand = instrument_number_to;
+
+    return 0;
 }
 
 int mlua_icg_fcb_block_link_relative(struct mlua_icg_fcb_block *icg_fcb_block, \
         uint32_t instrument_number_from, uint32_t instrument_number_to)
 {
-    struct mlua_icg_fcb_line *icg_fcb_line_cur;
-    uint32_t instrument_number_from_bak = instrument_number_from;
+    if (instrument_number_from >= icg_fcb_block->size) return -1;
 
-    icg_fcb_line_cur = icg_fcb_block->begin;
-    while ((instrument_number_from != 0) && (icg_fcb_line_cur != NULL))
-    {
-        icg_fcb_line_cur = icg_fcb_line_cur->next; 
-        instrument_number_from -= 1;
-    }
-    if (icg_fcb_line_cur != NULL) 
-    {
-        icg_fcb_line_cur->operand = snr_sam_to_cmp((int32_t)instrument_number_to - (int32_t)instrument_number_from_bak);
-        return 0;
-    }
-    else
-    {
-        return -1;
-    }
+    icg_fcb_block->lines[instrument_number_from]->operand = \
+        snr_sam_to_cmp((int32_t)instrument_number_to - (int32_t)instrument_number_from);
+
+    return 0;
 }
 
 struct mlua_icg_fcb_block_list *mlua_icg_fcb_block_list_new(void)
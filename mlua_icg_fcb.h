@@ -74,20 +74,20 @@ struct mlua_icg_fcb_line
     uint32_t operand;
     int type;
     struct mlua_icg_fcb_line_attr_list *attrs;
-
-    struct mlua_icg_fcb_line *prev;
-    struct mlua_icg_fcb_line *next;
 };
 struct mlua_icg_fcb_line *mlua_icg_fcb_line_new(void);
 int mlua_icg_fcb_line_destroy(struct mlua_icg_fcb_line *icg_fcb_line);
 struct mlua_icg_fcb_line *mlua_icg_fcb_line_new_with_configure(uint32_t opcode, uint32_t operand);
 struct mlua_icg_fcb_line *mlua_icg_fcb_line_new_with_configure_type(uint32_t opcode, uint32_t operand, int type);
 
+#define MLUA_ICG_FCB_BLOCK_INIT_CAPACITY 16
+
 struct mlua_icg_fcb_block
 {
-    struct mlua_icg_fcb_line *begin;
-    struct mlua_icg_fcb_line *end;
+    /* lines[instrument_number] */
+    struct mlua_icg_fcb_line **lines;
     size_t size;
+    size_t capacity;
 
     struct mlua_icg_fcb_block *prev;
     struct mlua_icg_fcb_block *next;
@@ -99,6 +99,10 @@ int mlua_icg_fcb_block_append(struct mlua_icg_fcb_block *icg_fcb_block, \
 int mlua_icg_fcb_block_insert(struct mlua_icg_fcb_block *icg_fcb_block, \
         uint32_t instrument_number_insert, \
         struct mlua_icg_fcb_line *new_icg_fcb_line);
+/* Move all lines of 'icg_fcb_block_src' in front of 'instrument_number_insert' at once */
+int mlua_icg_fcb_block_insert_block(struct mlua_icg_fcb_block *icg_fcb_block, \
+        uint32_t instrument_number_insert, \
+        struct mlua_icg_fcb_block *icg_fcb_block_src);
 
 int mlua_icg_fcb_block_append_with_configure(struct mlua_icg_fcb_block *icg_fcb_block, \
         uint32_t opcode, uint32_t operand);
@@ -27,6 +27,10 @@ static const char *customizable_built_in_procedures[] =
     "type", 
     "tonumber", 
     "tostring", 
+    "dofile", 
+    "load", 
+    "loadfile", 
+    "loadstring", 
 };
 #define CUSTOMIZABLE_BUILT_IN_PROCEDURE_COUNT (sizeof(customizable_built_in_procedures)/sizeof(const char *))
 
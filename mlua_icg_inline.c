@@ -0,0 +1,1147 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Inline
+ * Copyright(C) 2014 Cheryl Natsu
+
+ * This file is part of multiple - Multiple Paradigm Language Interpreter
+
+ * multiple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * multiple is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+ */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "multiply.h"
+#include "multiply_str_aux.h"
+
+#include "vm_opcode.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_icg.h"
+#include "mlua_icg_fcb.h"
+#include "mlua_icg_context.h"
+#include "mlua_icg_expr.h"
+#include "mlua_icg_chunk.h"
+
+#include "mlua_icg_inline.h"
+#include "mlua_icg_stdlib_base.h"
+#include "mlua_icg_stdlib_bitwise.h"
+#include "mlua_icg_stdlib_math.h"
+#include "mlua_icg_stdlib_string.h"
+
+#define MLUA_ICG_INLINE_BUFFER_INIT_CAPACITY 64
+
+static const struct mlua_icg_inline_handler *const mlua_icg_inline_handler_tables[] =
+{
+    mlua_icg_inline_handlers_base,
+    mlua_icg_inline_handlers_bitwise,
+    mlua_icg_inline_handlers_string,
+    NULL,
+};
+
+const struct mlua_icg_inline_handler *mlua_icg_inline_handler_lookup(char *name, size_t name_len)
+{
+    const struct mlua_icg_inline_handler *const *table_cur;
+    const struct mlua_icg_inline_handler *handler_cur;
+
+    for (table_cur = mlua_icg_inline_handler_tables; *table_cur != NULL; table_cur++)
+    {
+        for (handler_cur = *table_cur; handler_cur->name != NULL; handler_cur++)
+        {
+            if ((handler_cur->name_len == name_len) && \
+                    (strncmp(handler_cur->name, name, name_len) == 0))
+            {
+                return handler_cur;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static const struct mlua_icg_inline_constant *const mlua_icg_inline_constant_tables[] =
+{
+    mlua_icg_inline_constants_math,
+    NULL,
+};
+
+const struct mlua_icg_inline_constant *mlua_icg_inline_constant_lookup(char *name, size_t name_len)
+{
+    const struct mlua_icg_inline_constant *const *table_cur;
+    const struct mlua_icg_inline_constant *constant_cur;
+
+    for (table_cur = mlua_icg_inline_constant_tables; *table_cur != NULL; table_cur++)
+    {
+        for (constant_cur = *table_cur; constant_cur->name != NULL; constant_cur++)
+        {
+            if ((constant_cur->name_len == name_len) && \
+                    (strncmp(constant_cur->name, name, name_len) == 0))
+            {
+                return constant_cur;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/* Bindings */
+
+/* A name of a handler or a constant is 'name' itself or 
+ * a field of the table 'name' */
+static int mlua_icg_inline_name_used(const char *name, size_t name_len)
+{
+    const struct mlua_icg_inline_handler *const *handler_table_cur;
+    const struct mlua_icg_inline_handler *handler_cur;
+    const struct mlua_icg_inline_constant *const *constant_table_cur;
+    const struct mlua_icg_inline_constant *constant_cur;
+
+    for (handler_table_cur = mlua_icg_inline_handler_tables; *handler_table_cur != NULL; handler_table_cur++)
+    {
+        for (handler_cur = *handler_table_cur; handler_cur->name != NULL; handler_cur++)
+        {
+            if ((handler_cur->name_len >= name_len) && \
+                    (strncmp(handler_cur->name, name, name_len) == 0) && \
+                    ((handler_cur->name_len == name_len) || (handler_cur->name[name_len] == '.')))
+            { return 1; }
+        }
+    }
+    for (constant_table_cur = mlua_icg_inline_constant_tables; *constant_table_cur != NULL; constant_table_cur++)
+    {
+        for (constant_cur = *constant_table_cur; constant_cur->name != NULL; constant_cur++)
+        {
+            if ((constant_cur->name_len >= name_len) && \
+                    (strncmp(constant_cur->name, name, name_len) == 0) && \
+                    ((constant_cur->name_len == name_len) || (constant_cur->name[name_len] == '.')))
+            { return 1; }
+        }
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_name_is_env(struct token *name)
+{
+    return (((name->len == 2) && (strncmp(name->str, "_G", 2) == 0)) || \
+            ((name->len == 4) && (strncmp(name->str, "_ENV", 4) == 0))) ? 1 : 0;
+}
+
+struct mlua_icg_inline_bindings *mlua_icg_inline_bindings_new(void)
+{
+    struct mlua_icg_inline_bindings *new_bindings = NULL;
+
+    if ((new_bindings = (struct mlua_icg_inline_bindings *)malloc( \
+                    sizeof(struct mlua_icg_inline_bindings))) == NULL)
+    { return NULL; }
+    new_bindings->begin = NULL;
+    new_bindings->loads = NULL;
+    new_bindings->dynamic = 0;
+
+    return new_bindings;
+}
+
+int mlua_icg_inline_bindings_destroy(struct mlua_icg_inline_bindings *bindings)
+{
+    struct mlua_icg_inline_binding *binding_cur, *binding_next;
+    struct mlua_icg_inline_load *load_cur, *load_next;
+
+    binding_cur = bindings->begin;
+    while (binding_cur != NULL)
+    {
+        binding_next = binding_cur->next; 
+        free(binding_cur);
+        binding_cur = binding_next;
+    }
+    load_cur = bindings->loads;
+    while (load_cur != NULL)
+    {
+        load_next = load_cur->next; 
+        free(load_cur);
+        load_cur = load_next;
+    }
+    free(bindings);
+
+    return 0;
+}
+
+/* 'field' is NULL when the name 'table' itself is bound */
+static int mlua_icg_inline_bindings_add(struct mlua_icg_inline_bindings *bindings, \
+        struct token *table, struct token *field)
+{
+    struct mlua_icg_inline_binding *binding_cur, *new_binding;
+    size_t field_len = (field != NULL) ? field->len : 0;
+
+    /* Names no handler goes by are not kept */
+    if (mlua_icg_inline_name_used(table->str, table->len) == 0) return 0;
+
+    binding_cur = bindings->begin;
+    while (binding_cur != NULL)
+    {
+        if ((binding_cur->table_len == table->len) && \
+                (strncmp(binding_cur->table, table->str, table->len) == 0) && \
+                ((binding_cur->field == NULL) || \
+                 ((field != NULL) && (binding_cur->field_len == field->len) && \
+                  (strncmp(binding_cur->field, field->str, field->len) == 0))))
+        { return 0; }
+        binding_cur = binding_cur->next; 
+    }
+
+    /* Names are kept after the tokens of a chunk are gone */
+    if ((new_binding = (struct mlua_icg_inline_binding *)malloc( \
+                    sizeof(struct mlua_icg_inline_binding) + table->len + field_len)) == NULL)
+    { return -MULTIPLE_ERR_MALLOC; }
+    new_binding->table = (char *)(new_binding + 1);
+    new_binding->table_len = table->len;
+    memcpy(new_binding->table, table->str, table->len);
+    new_binding->field = NULL;
+    new_binding->field_len = 0;
+    if (field != NULL)
+    {
+        new_binding->field = new_binding->table + table->len;
+        new_binding->field_len = field->len;
+        memcpy(new_binding->field, field->str, field->len);
+    }
+    new_binding->next = bindings->begin;
+    bindings->begin = new_binding;
+
+    return 0;
+}
+
+/* Name assigned or declared */
+static int mlua_icg_inline_bindings_add_name(struct mlua_icg_inline_bindings *bindings, \
+        struct token *name)
+{
+    if (mlua_icg_inline_name_is_env(name) != 0)
+    {
+        /* 'local _ENV = ...' or '_ENV = ...' */
+        if (name->len == 4) bindings->dynamic = 1;
+        return 0;
+    }
+    return mlua_icg_inline_bindings_add(bindings, name, NULL);
+}
+
+/* 'table.field' assigned, 'field' is NULL for 'table[exp]' */
+static int mlua_icg_inline_bindings_add_field(struct mlua_icg_inline_bindings *bindings, \
+        struct token *table, struct token *field)
+{
+    if (mlua_icg_inline_name_is_env(table) != 0)
+    {
+        /* '_G.name = ...' binds the global 'name', 
+         * '_G[exp] = ...' may bind any */
+        if (field == NULL) { bindings->dynamic = 1; return 0; }
+        return mlua_icg_inline_bindings_add(bindings, field, NULL);
+    }
+    return mlua_icg_inline_bindings_add(bindings, table, field);
+}
+
+static int mlua_icg_inline_bindings_add_target(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression *exp)
+{
+    struct mlua_ast_expression_suffixed *exp_suffixed;
+    struct mlua_ast_expression_suffixed *exp_sub_suffixed;
+    struct mlua_ast_expression *exp_sub;
+    struct token *field;
+
+    if ((exp->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY) && \
+            (exp->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME))
+    {
+        return mlua_icg_inline_bindings_add_name(bindings, exp->u.primary->u.name);
+    }
+    if (exp->type != MLUA_AST_EXPRESSION_TYPE_SUFFIXED) return 0;
+
+    exp_suffixed = exp->u.suffixed;
+    field = (exp_suffixed->type == MLUA_AST_EXPRESSION_SUFFIXED_TYPE_MEMBER) ? \
+            exp_suffixed->u.name : NULL;
+    exp_sub = exp_suffixed->sub;
+    if ((exp_sub->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY) && \
+            (exp_sub->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME))
+    {
+        /* 'table.field = ...' */
+        return mlua_icg_inline_bindings_add_field(bindings, exp_sub->u.primary->u.name, field);
+    }
+    if (exp_sub->type == MLUA_AST_EXPRESSION_TYPE_SUFFIXED)
+    {
+        /* '_G.table.field = ...' */
+        exp_sub_suffixed = exp_sub->u.suffixed;
+        if ((exp_sub_suffixed->type == MLUA_AST_EXPRESSION_SUFFIXED_TYPE_MEMBER) && \
+                (exp_sub_suffixed->sub->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY) && \
+                (exp_sub_suffixed->sub->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME) && \
+                (mlua_icg_inline_name_is_env(exp_sub_suffixed->sub->u.primary->u.name) != 0))
+        {
+            return mlua_icg_inline_bindings_add(bindings, exp_sub_suffixed->u.name, field);
+        }
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_statement_list(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_statement_list *list);
+static int mlua_icg_inline_bindings_collect_expression(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression *exp);
+
+static int mlua_icg_inline_bindings_collect_expression_list(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression_list *list)
+{
+    int ret;
+    struct mlua_ast_expression *exp_cur;
+
+    if (list == NULL) return 0;
+    exp_cur = list->begin;
+    while (exp_cur != NULL)
+    {
+        if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, exp_cur)) != 0) return ret;
+        exp_cur = exp_cur->next;
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_pars(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_par_list *pars)
+{
+    int ret;
+    struct mlua_ast_par *par_cur;
+
+    if (pars == NULL) return 0;
+    par_cur = pars->begin;
+    while (par_cur != NULL)
+    {
+        if ((ret = mlua_icg_inline_bindings_add_name(bindings, par_cur->name)) != 0) return ret;
+        par_cur = par_cur->next;
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_fieldlist(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_fieldlist *fieldlist)
+{
+    int ret = 0;
+    struct mlua_ast_field *field_cur;
+
+    if (fieldlist == NULL) return 0;
+    field_cur = fieldlist->begin;
+    while (field_cur != NULL)
+    {
+        switch (field_cur->type)
+        {
+            case MLUA_AST_FIELD_TYPE_ARRAY:
+                if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, field_cur->u.array->index)) != 0) return ret;
+                ret = mlua_icg_inline_bindings_collect_expression(bindings, field_cur->u.array->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_PROPERTY:
+                ret = mlua_icg_inline_bindings_collect_expression(bindings, field_cur->u.property->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_EXP:
+                ret = mlua_icg_inline_bindings_collect_expression(bindings, field_cur->u.exp->value);
+                break;
+            case MLUA_AST_FIELD_TYPE_UNKNOWN:
+                break;
+        }
+        if (ret != 0) return ret;
+        field_cur = field_cur->next;
+    }
+
+    return 0;
+}
+
+/* 'load' and 'loadstring' called by their names */
+static int mlua_icg_inline_bindings_collect_load(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression_funcall *funcall)
+{
+    struct mlua_ast_expression_primary *exp_primary;
+    struct mlua_icg_inline_load *new_load;
+
+    if ((funcall->args == NULL) || \
+            (funcall->prefixexp == NULL) || \
+            (funcall->prefixexp->type != MLUA_AST_EXPRESSION_TYPE_PRIMARY))
+    { return 0; }
+    exp_primary = funcall->prefixexp->u.primary;
+    if (exp_primary->type != MLUA_AST_EXPRESSION_PRIMARY_TYPE_NAME) return 0;
+    if (!(((exp_primary->u.name->len == 4) && \
+                    (strncmp(exp_primary->u.name->str, "load", 4) == 0)) || \
+                ((exp_primary->u.name->len == 10) && \
+                 (strncmp(exp_primary->u.name->str, "loadstring", 10) == 0))))
+    { return 0; }
+
+    if ((new_load = (struct mlua_icg_inline_load *)malloc( \
+                    sizeof(struct mlua_icg_inline_load))) == NULL)
+    { return -MULTIPLE_ERR_MALLOC; }
+    new_load->name = exp_primary->u.name;
+    new_load->args = funcall->args;
+    new_load->next = bindings->loads;
+    bindings->loads = new_load;
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_funcall(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression_funcall *funcall)
+{
+    int ret;
+
+    if (funcall == NULL) return 0;
+    if ((ret = mlua_icg_inline_bindings_collect_load(bindings, funcall)) != 0) return ret;
+    if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, funcall->prefixexp)) != 0) return ret;
+    if (funcall->args == NULL) return 0;
+    switch (funcall->args->type)
+    {
+        case MLUA_AST_ARGS_TYPE_EXPLIST:
+            return mlua_icg_inline_bindings_collect_expression_list(bindings, funcall->args->u.explist);
+        case MLUA_AST_ARGS_TYPE_TBLCTOR:
+            if (funcall->args->u.tblctor == NULL) return 0;
+            return mlua_icg_inline_bindings_collect_fieldlist(bindings, funcall->args->u.tblctor->fieldlist);
+        case MLUA_AST_ARGS_TYPE_STRING:
+        case MLUA_AST_ARGS_TYPE_UNKNOWN:
+            break;
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_expression(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_expression *exp)
+{
+    int ret;
+
+    if (exp == NULL) return 0;
+    switch (exp->type)
+    {
+        case MLUA_AST_EXPRESSION_TYPE_PREFIX:
+            if (exp->u.prefix == NULL) break;
+            if (exp->u.prefix->type == MLUA_AST_PREFIX_EXP_TYPE_FUNCALL)
+            { return mlua_icg_inline_bindings_collect_funcall(bindings, exp->u.prefix->u.funcall); }
+            else if (exp->u.prefix->type == MLUA_AST_PREFIX_EXP_TYPE_EXP)
+            { return mlua_icg_inline_bindings_collect_expression(bindings, exp->u.prefix->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_PRIMARY:
+            if ((exp->u.primary != NULL) && \
+                    (exp->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_EXPR))
+            { return mlua_icg_inline_bindings_collect_expression(bindings, exp->u.primary->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_SUFFIXED:
+            if (exp->u.suffixed == NULL) break;
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, exp->u.suffixed->sub)) != 0) return ret;
+            if (exp->u.suffixed->type == MLUA_AST_EXPRESSION_SUFFIXED_TYPE_INDEX)
+            { return mlua_icg_inline_bindings_collect_expression(bindings, exp->u.suffixed->u.exp); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_TBLCTOR:
+            if (exp->u.tblctor != NULL)
+            { return mlua_icg_inline_bindings_collect_fieldlist(bindings, exp->u.tblctor->fieldlist); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_FUNCALL:
+            return mlua_icg_inline_bindings_collect_funcall(bindings, exp->u.funcall);
+
+        case MLUA_AST_EXPRESSION_TYPE_FUNDEF:
+            if (exp->u.fundef == NULL) break;
+            if ((ret = mlua_icg_inline_bindings_collect_pars(bindings, exp->u.fundef->pars)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_statement_list(bindings, exp->u.fundef->body);
+
+        case MLUA_AST_EXPRESSION_TYPE_UNOP:
+            if (exp->u.unop != NULL)
+            { return mlua_icg_inline_bindings_collect_expression(bindings, exp->u.unop->sub); }
+            break;
+
+        case MLUA_AST_EXPRESSION_TYPE_BINOP:
+            if (exp->u.binop == NULL) break;
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, exp->u.binop->left)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_expression(bindings, exp->u.binop->right);
+
+        case MLUA_AST_EXPRESSION_TYPE_FACTOR:
+        case MLUA_AST_EXPRESSION_TYPE_UNKNOWN:
+            break;
+    }
+
+    return 0;
+}
+
+static int mlua_icg_inline_bindings_collect_fundef(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_statement_fundef *stmt_fundef)
+{
+    int ret;
+    struct mlua_ast_name *name_first, *name_second;
+
+    name_first = stmt_fundef->funcname->name_list->begin;
+    name_second = (name_first != NULL) ? name_first->next : NULL;
+    if (name_first != NULL)
+    {
+        if ((name_second == NULL) && (stmt_fundef->funcname->member == NULL))
+        {
+            /* 'function name()' and 'local function name()' */
+            ret = mlua_icg_inline_bindings_add_name(bindings, name_first->name);
+        }
+        else if ((name_second != NULL) && (name_second->next != NULL) && \
+                (mlua_icg_inline_name_is_env(name_first->name) != 0))
+        {
+            /* 'function _G.table.field()' */
+            ret = mlua_icg_inline_bindings_add(bindings, name_second->name, name_second->next->name);
+        }
+        else
+        {
+            /* 'function table.field()' and 'function table:field()' */
+            ret = mlua_icg_inline_bindings_add_field(bindings, name_first->name, \
+                    (name_second != NULL) ? name_second->name : stmt_fundef->funcname->member->name);
+        }
+        if (ret != 0) return ret;
+    }
+
+    if ((ret = mlua_icg_inline_bindings_collect_pars(bindings, stmt_fundef->parameters)) != 0) return ret;
+    return mlua_icg_inline_bindings_collect_statement_list(bindings, stmt_fundef->body);
+}
+
+static int mlua_icg_inline_bindings_collect_statement(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_statement *stmt)
+{
+    int ret = 0;
+    struct mlua_ast_statement_elseif *elseif_cur;
+    struct mlua_ast_expression *exp_cur;
+    struct mlua_ast_name *name_cur;
+
+    switch (stmt->type)
+    {
+        case MLUA_AST_STATEMENT_TYPE_ASSIGNMENT:
+            exp_cur = stmt->u.stmt_assignment->varlist->begin;
+            while (exp_cur != NULL)
+            {
+                if ((ret = mlua_icg_inline_bindings_add_target(bindings, exp_cur)) != 0) return ret;
+                exp_cur = exp_cur->next;
+            }
+            if ((ret = mlua_icg_inline_bindings_collect_expression_list(bindings, \
+                            stmt->u.stmt_assignment->varlist)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_expression_list(bindings, \
+                    stmt->u.stmt_assignment->explist);
+        case MLUA_AST_STATEMENT_TYPE_EXPR:
+            return mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_expr->expr);
+        case MLUA_AST_STATEMENT_TYPE_FUNCALL:
+            return mlua_icg_inline_bindings_collect_funcall(bindings, stmt->u.funcall);
+        case MLUA_AST_STATEMENT_TYPE_IF:
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_if->exp)) != 0) return ret;
+            if ((ret = mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_if->block_then)) != 0) return ret;
+            elseif_cur = stmt->u.stmt_if->elseif;
+            while (elseif_cur != NULL)
+            {
+                if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, elseif_cur->exp)) != 0) return ret;
+                if ((ret = mlua_icg_inline_bindings_collect_statement_list(bindings, elseif_cur->block_then)) != 0) return ret;
+                elseif_cur = elseif_cur->elseif;
+            }
+            return mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_if->block_else);
+        case MLUA_AST_STATEMENT_TYPE_WHILE:
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_while->exp)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_while->block);
+        case MLUA_AST_STATEMENT_TYPE_REPEAT:
+            if ((ret = mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_repeat->block)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_repeat->exp);
+        case MLUA_AST_STATEMENT_TYPE_DO:
+            return mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_do->block);
+        case MLUA_AST_STATEMENT_TYPE_FOR:
+            name_cur = stmt->u.stmt_for->name;
+            while (name_cur != NULL)
+            {
+                if ((ret = mlua_icg_inline_bindings_add_name(bindings, name_cur->name)) != 0) return ret;
+                name_cur = name_cur->next;
+            }
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_for->exp1)) != 0) return ret;
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_for->exp2)) != 0) return ret;
+            if ((ret = mlua_icg_inline_bindings_collect_expression(bindings, stmt->u.stmt_for->exp3)) != 0) return ret;
+            return mlua_icg_inline_bindings_collect_statement_list(bindings, stmt->u.stmt_for->block);
+        case MLUA_AST_STATEMENT_TYPE_LOCAL:
+            name_cur = stmt->u.stmt_local->namelist->begin;
+            while (name_cur != NULL)
+            {
+                if ((ret = mlua_icg_inline_bindings_add_name(bindings, name_cur->name)) != 0) return ret;
+                name_cur = name_cur->next;
+            }
+            return mlua_icg_inline_bindings_collect_expression_list(bindings, stmt->u.stmt_local->explist);
+        case MLUA_AST_STATEMENT_TYPE_FUNDEF:
+            return mlua_icg_inline_bindings_collect_fundef(bindings, stmt->u.stmt_fundef);
+        case MLUA_AST_STATEMENT_TYPE_RETURN:
+            return mlua_icg_inline_bindings_collect_expression_list(bindings, stmt->u.stmt_return->explist);
+        case MLUA_AST_STATEMENT_TYPE_BREAK:
+        case MLUA_AST_STATEMENT_TYPE_LABEL:
+        case MLUA_AST_STATEMENT_TYPE_GOTO:
+        case MLUA_AST_STATEMENT_TYPE_UNKNOWN:
+            break;
+    }
+
+    return ret;
+}
+
+static int mlua_icg_inline_bindings_collect_statement_list(struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_ast_statement_list *list)
+{
+    int ret;
+    struct mlua_ast_statement *stmt_cur;
+
+    if (list == NULL) return 0;
+    stmt_cur = list->begin;
+    while (stmt_cur != NULL)
+    {
+        if ((ret = mlua_icg_inline_bindings_collect_statement(bindings, stmt_cur)) != 0) return ret;
+        stmt_cur = stmt_cur->next;
+    }
+
+    return 0;
+}
+
+/* The chunk a site loads when it is compiled, NULL otherwise, 
+ * the conditions are those 'mlua_icg_inline_base_load' inlines on */
+static int mlua_icg_inline_bindings_load_chunk(struct multiple_error *err, \
+        struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_icg_chunk_map *chunks, \
+        struct mlua_icg_inline_load *load, \
+        struct mlua_icg_chunk **chunk_out)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *args = NULL;
+
+    *chunk_out = NULL;
+
+    if (mlua_icg_inline_bindings_bound(bindings, load->name->str, load->name->len) != 0)
+    { goto done; }
+    if ((ret = mlua_icg_inline_args_new(err, &args, load->args)) != 0)
+    {
+        if (ret == MLUA_ICG_INLINE_DECLINED) ret = 0;
+        goto done;
+    }
+    if ((args->size < 1) || (args->args[0].type != MLUA_ICG_INLINE_ARG_TYPE_STRING))
+    { goto done; }
+    if ((args->size >= 4) && (args->args[3].type != MLUA_ICG_INLINE_ARG_TYPE_NIL))
+    { goto done; }
+
+    /* Every source is parsed once */
+    if (mlua_icg_chunk_map_lookup(chunks, args->args[0].str, args->args[0].len) != NULL)
+    { goto done; }
+    if ((ret = mlua_icg_chunk_map_parse(err, chunks, chunk_out, \
+                    args->args[0].str, args->args[0].len)) != 0)
+    { goto fail; }
+
+    goto done;
+fail:
+done:
+    if (args != NULL) mlua_icg_inline_args_destroy(args);
+    return ret;
+}
+
+int mlua_icg_inline_bindings_collect(struct multiple_error *err, \
+        struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_icg_chunk_map *chunks, \
+        struct mlua_ast_statement_list *stmts)
+{
+    int ret;
+    struct mlua_icg_inline_load *load;
+    struct mlua_icg_chunk *chunk;
+
+    if ((ret = mlua_icg_inline_bindings_collect_statement_list(bindings, stmts)) != 0)
+    { goto fail; }
+
+    /* Chunks loaded from the chunks are collected as well */
+    while (bindings->loads != NULL)
+    {
+        load = bindings->loads;
+        bindings->loads = load->next;
+        ret = mlua_icg_inline_bindings_load_chunk(err, bindings, chunks, load, &chunk);
+        free(load);
+        if (ret != 0) return ret;
+        if (chunk == NULL) continue;
+
+        if ((ret = mlua_icg_inline_bindings_collect_statement_list(bindings, \
+                        chunk->program->stmts)) != 0)
+        { goto fail; }
+    }
+
+    return 0;
+fail:
+    if (ret == -MULTIPLE_ERR_MALLOC) { MULTIPLE_ERROR_MALLOC(); }
+    return ret;
+}
+
+int mlua_icg_inline_bindings_bound(struct mlua_icg_inline_bindings *bindings, \
+        char *name, size_t name_len)
+{
+    struct mlua_icg_inline_binding *binding_cur;
+    char *dot;
+    size_t table_len, field_len;
+
+    if (bindings == NULL) return 0;
+    if (bindings->dynamic != 0) return 1;
+
+    dot = (char *)memchr(name, '.', name_len);
+    table_len = (dot != NULL) ? (size_t)(dot - name) : name_len;
+    field_len = (dot != NULL) ? name_len - table_len - 1 : 0;
+
+    binding_cur = bindings->begin;
+    while (binding_cur != NULL)
+    {
+        if ((binding_cur->table_len == table_len) && \
+                (strncmp(binding_cur->table, name, table_len) == 0))
+        {
+            if (binding_cur->field == NULL) return 1;
+            if ((dot != NULL) && (binding_cur->field_len == field_len) && \
+                    (strncmp(binding_cur->field, dot + 1, field_len) == 0))
+            { return 1; }
+        }
+        binding_cur = binding_cur->next; 
+    }
+
+    return 0;
+}
+
+
+/* Arguments */
+
+static int mlua_icg_inline_arg_init(struct multiple_error *err, \
+        struct mlua_icg_inline_arg *arg, \
+        struct mlua_ast_expression *exp)
+{
+    int ret = 0;
+    struct mlua_ast_expression_factor *factor;
+    struct mlua_ast_expression *sub;
+
+    arg->exp = exp;
+
+    /* '(exp)' */
+    while ((exp->type == MLUA_AST_EXPRESSION_TYPE_PRIMARY) && \
+            (exp->u.primary->type == MLUA_AST_EXPRESSION_PRIMARY_TYPE_EXPR))
+    {
+        exp = exp->u.primary->u.exp;
+    }
+
+    /* '-' Number */
+    if ((exp->type == MLUA_AST_EXPRESSION_TYPE_UNOP) && \
+            (exp->u.unop->op->value == '-'))
+    {
+        sub = exp->u.unop->sub;
+        if ((sub->type != MLUA_AST_EXPRESSION_TYPE_FACTOR) || \
+                ((sub->u.factor->type != MLUA_AST_EXP_FACTOR_TYPE_INTEGER) && \
+                 (sub->u.factor->type != MLUA_AST_EXP_FACTOR_TYPE_FLOAT)))
+        { goto done; }
+        if ((ret = mlua_icg_inline_arg_init(err, arg, sub)) != 0) { goto fail; }
+        arg->exp = exp;
+        arg->value_int = -arg->value_int;
+        arg->value_float = -arg->value_float;
+        goto done;
+    }
+
+    if (exp->type != MLUA_AST_EXPRESSION_TYPE_FACTOR) { goto done; }
+    factor = exp->u.factor;
+
+    switch (factor->type)
+    {
+        case MLUA_AST_EXP_FACTOR_TYPE_NIL:
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_NIL;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_FALSE:
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_FALSE;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_TRUE:
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_TRUE;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_INTEGER:
+            /* Left to the normal generation to report */
+            if (multiply_convert_str_to_int(&arg->value_int, \
+                        factor->token->str, factor->token->len) != 0)
+            { goto done; }
+            arg->value_float = (double)arg->value_int;
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_INTEGER;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_FLOAT:
+            if (multiply_convert_str_to_float(&arg->value_float, \
+                        factor->token->str, factor->token->len) != 0)
+            { goto done; }
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_FLOAT;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_STRING:
+            arg->len = factor->token->len;
+            arg->str = (char *)malloc(sizeof(char) * (arg->len + 1));
+            if (arg->str == NULL)
+            {
+                MULTIPLE_ERROR_MALLOC();
+                ret = -MULTIPLE_ERR_MALLOC;
+                goto fail; 
+            }
+            memcpy(arg->str, factor->token->str, factor->token->len);
+            arg->str[arg->len] = '\0';
+            multiply_replace_escape_chars(arg->str, &arg->len);
+            arg->type = MLUA_ICG_INLINE_ARG_TYPE_STRING;
+            break;
+
+        case MLUA_AST_EXP_FACTOR_TYPE_UNKNOWN:
+            break;
+    }
+
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+int mlua_icg_inline_args_new(struct multiple_error *err, \
+        struct mlua_icg_inline_args **args_out, \
+        struct mlua_ast_args *args)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *new_args = NULL;
+    struct mlua_ast_expression *exp_cur;
+    size_t size, idx;
+
+    *args_out = NULL;
+
+    switch (args->type)
+    {
+        case MLUA_AST_ARGS_TYPE_STRING:
+            size = 1;
+            break;
+        case MLUA_AST_ARGS_TYPE_EXPLIST:
+            size = args->u.explist->size;
+            break;
+        case MLUA_AST_ARGS_TYPE_TBLCTOR:
+            return MLUA_ICG_INLINE_DECLINED;
+        case MLUA_AST_ARGS_TYPE_UNKNOWN:
+        default:
+            MULTIPLE_ERROR_INTERNAL();
+            return -MULTIPLE_ERR_INTERNAL;
+    }
+
+    new_args = (struct mlua_icg_inline_args *)malloc(sizeof(struct mlua_icg_inline_args));
+    if (new_args == NULL) { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    new_args->size = size;
+    new_args->constant = 1;
+    new_args->last_multiple = 0;
+    new_args->args = (struct mlua_icg_inline_arg *)malloc( \
+            sizeof(struct mlua_icg_inline_arg) * (size + 1));
+    if (new_args->args == NULL) { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    for (idx = 0; idx != size; idx++)
+    {
+        new_args->args[idx].type = MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN;
+        new_args->args[idx].exp = NULL;
+        new_args->args[idx].value_int = 0;
+        new_args->args[idx].value_float = 0.0;
+        new_args->args[idx].str = NULL;
+        new_args->args[idx].len = 0;
+    }
+
+    if (args->type == MLUA_AST_ARGS_TYPE_STRING)
+    {
+        new_args->args[0].len = args->u.str->len;
+        new_args->args[0].str = (char *)malloc(sizeof(char) * (args->u.str->len + 1));
+        if (new_args->args[0].str == NULL)
+        { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+        memcpy(new_args->args[0].str, args->u.str->str, args->u.str->len);
+        new_args->args[0].str[args->u.str->len] = '\0';
+        multiply_replace_escape_chars(new_args->args[0].str, &new_args->args[0].len);
+        new_args->args[0].type = MLUA_ICG_INLINE_ARG_TYPE_STRING;
+    }
+    else
+    {
+        idx = 0;
+        for (exp_cur = args->u.explist->begin; exp_cur != NULL; exp_cur = exp_cur->next)
+        {
+            if ((ret = mlua_icg_inline_arg_init(err, &new_args->args[idx], exp_cur)) != 0)
+            { goto fail; }
+            if (new_args->args[idx].type == MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN)
+            {
+                new_args->constant = 0;
+            }
+            if ((exp_cur->next == NULL) && \
+                    (exp_cur->type == MLUA_AST_EXPRESSION_TYPE_FUNCALL))
+            {
+                new_args->last_multiple = 1;
+            }
+            idx++;
+        }
+    }
+
+    *args_out = new_args;
+    new_args = NULL;
+
+    goto done;
+fail:
+done:
+    if (new_args != NULL) mlua_icg_inline_args_destroy(new_args);
+    return ret;
+}
+
+int mlua_icg_inline_args_destroy(struct mlua_icg_inline_args *args)
+{
+    size_t idx;
+
+    if (args->args != NULL)
+    {
+        for (idx = 0; idx != args->size; idx++)
+        {
+            if (args->args[idx].str != NULL) free(args->args[idx].str);
+        }
+        free(args->args);
+    }
+    free(args);
+
+    return 0;
+}
+
+int mlua_icg_inline_arg_to_int(struct mlua_icg_inline_arg *arg, int *value_out)
+{
+    switch (arg->type)
+    {
+        case MLUA_ICG_INLINE_ARG_TYPE_INTEGER:
+            *value_out = arg->value_int;
+            return 0;
+
+        case MLUA_ICG_INLINE_ARG_TYPE_FLOAT:
+            if ((arg->value_float < -2147483648.0) || \
+                    (arg->value_float > 2147483647.0) || \
+                    ((double)(int)arg->value_float != arg->value_float))
+            { return -1; }
+            *value_out = (int)arg->value_float;
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+int mlua_icg_inline_arg_to_float(struct mlua_icg_inline_arg *arg, double *value_out)
+{
+    switch (arg->type)
+    {
+        case MLUA_ICG_INLINE_ARG_TYPE_INTEGER:
+            *value_out = (double)arg->value_int;
+            return 0;
+
+        case MLUA_ICG_INLINE_ARG_TYPE_FLOAT:
+            *value_out = arg->value_float;
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+int mlua_icg_inline_arg_to_str(struct mlua_icg_inline_arg *arg, \
+        char **str_out, size_t *len_out)
+{
+    char buffer[64];
+    int len;
+
+    /* Strings, or numbers converted before */
+    if (arg->str != NULL) 
+    {
+        *str_out = arg->str;
+        *len_out = arg->len;
+        return 0;
+    }
+
+    switch (arg->type)
+    {
+        case MLUA_ICG_INLINE_ARG_TYPE_INTEGER:
+            len = snprintf(buffer, sizeof(buffer), "%d", arg->value_int);
+            break;
+
+        case MLUA_ICG_INLINE_ARG_TYPE_FLOAT:
+            len = snprintf(buffer, sizeof(buffer), "%.14g", arg->value_float);
+            break;
+
+        default:
+            return -1;
+    }
+
+    /* Keep the text for the rest of the generation */
+    if ((arg->str = (char *)malloc(sizeof(char) * ((size_t)len + 1))) == NULL)
+    { return -1; }
+    memcpy(arg->str, buffer, (size_t)len + 1);
+    arg->len = (size_t)len;
+    *str_out = arg->str;
+    *len_out = arg->len;
+
+    return 0;
+}
+
+
+/* Generation */
+
+int mlua_icg_inline_push_arg(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_icg_inline_arg *arg)
+{
+    int ret = 0;
+    uint32_t id;
+
+    switch (arg->type)
+    {
+        case MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN:
+            return mlua_icodegen_expression(err, \
+                    context, \
+                    icg_fcb_block, \
+                    arg->exp);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_NIL:
+            return mlua_icg_inline_push_none(err, context, icg_fcb_block);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_FALSE:
+            if ((ret = multiply_resource_get_false(err, context->icode, context->res_id, &id)) != 0) 
+            { return ret; }
+            return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_TRUE:
+            if ((ret = multiply_resource_get_true(err, context->icode, context->res_id, &id)) != 0) 
+            { return ret; }
+            return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_INTEGER:
+            return mlua_icg_inline_push_int(err, context, icg_fcb_block, arg->value_int);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_FLOAT:
+            return mlua_icg_inline_push_float(err, context, icg_fcb_block, arg->value_float);
+
+        case MLUA_ICG_INLINE_ARG_TYPE_STRING:
+            return mlua_icg_inline_push_str(err, context, icg_fcb_block, arg->str, arg->len);
+    }
+
+    MULTIPLE_ERROR_INTERNAL();
+    return -MULTIPLE_ERR_INTERNAL;
+}
+
+int mlua_icg_inline_drop_args(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_icg_inline_args *args, size_t idx)
+{
+    int ret = 0;
+
+    for (; idx < args->size; idx++)
+    {
+        if (args->args[idx].type != MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN) continue;
+        if ((ret = mlua_icodegen_expression(err, \
+                        context, \
+                        icg_fcb_block, \
+                        args->args[idx].exp)) != 0)
+        { return ret; }
+        if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_DROP, 0)) != 0)
+        { return ret; }
+    }
+
+    return ret;
+}
+
+int mlua_icg_inline_push_none(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block)
+{
+    int ret;
+    uint32_t id;
+
+    if ((ret = multiply_resource_get_none(err, context->icode, context->res_id, &id)) != 0) 
+    { return ret; }
+    return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+}
+
+int mlua_icg_inline_push_int(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        int value)
+{
+    int ret;
+    uint32_t id;
+
+    if ((ret = multiply_resource_get_int(err, context->icode, context->res_id, &id, value)) != 0) 
+    { return ret; }
+    return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+}
+
+int mlua_icg_inline_push_float(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        double value)
+{
+    int ret;
+    uint32_t id;
+
+    if ((ret = multiply_resource_get_float(err, context->icode, context->res_id, &id, value)) != 0) 
+    { return ret; }
+    return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+}
+
+int mlua_icg_inline_push_str(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        const char *str, size_t len)
+{
+    int ret;
+    uint32_t id;
+
+    if ((ret = multiply_resource_get_str(err, context->icode, context->res_id, &id, str, len)) != 0) 
+    { return ret; }
+    return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+}
+
+
+/* Buffer */
+
+int mlua_icg_inline_buffer_init(struct mlua_icg_inline_buffer *buffer)
+{
+    buffer->size = 0;
+    buffer->capacity = MLUA_ICG_INLINE_BUFFER_INIT_CAPACITY;
+    buffer->body = (char *)malloc(sizeof(char) * buffer->capacity);
+    if (buffer->body == NULL) { return -MULTIPLE_ERR_MALLOC; }
+
+    return 0;
+}
+
+void mlua_icg_inline_buffer_uninit(struct mlua_icg_inline_buffer *buffer)
+{
+    if (buffer->body != NULL)
+    {
+        free(buffer->body);
+        buffer->body = NULL;
+    }
+}
+
+int mlua_icg_inline_buffer_append(struct mlua_icg_inline_buffer *buffer, \
+        const char *str, size_t len)
+{
+    char *new_body;
+    size_t new_capacity;
+
+    if (buffer->size + len > buffer->capacity)
+    {
+        new_capacity = buffer->capacity;
+        while (buffer->size + len > new_capacity) new_capacity *= 2;
+        new_body = (char *)realloc(buffer->body, sizeof(char) * new_capacity);
+        if (new_body == NULL) { return -MULTIPLE_ERR_MALLOC; }
+        buffer->body = new_body;
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->body + buffer->size, str, len);
+    buffer->size += len;
+
+    return 0;
+}
+
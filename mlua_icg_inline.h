@@ -24,9 +24,23 @@
 #include <stdio.h>
 
 #include "multiple_err.h"
+#include "mlua_ast.h"
 #include "mlua_icg_context.h"
 #include "mlua_icg_fcb.h"
 
+/* Calls of standard library functions whose handler is found here are
+ * generated in place instead of calling the function in the table, 
+ * a handler leaves exactly one value on the stack, or returns
+ * MLUA_ICG_INLINE_DECLINED before generating anything and
+ * the normal call is generated */
+#define MLUA_ICG_INLINE_DECLINED 1
+
+/* Longest 'table.field' name to look up */
+#define MLUA_ICG_INLINE_NAME_LEN_MAX 64
+
+/* Longest string a call with constant arguments is folded into */
+#define MLUA_ICG_INLINE_STR_MAX 4096
+
 struct mlua_icg_inline_handler
 {
     const char *name;
@@ -38,7 +52,164 @@ struct mlua_icg_inline_handler
         struct mlua_ast_args *args);
 };
 
-struct mlua_icg_inline_handler *mlua_icg_inline_handler_lookup(char *name, size_t name_len);
+const struct mlua_icg_inline_handler *mlua_icg_inline_handler_lookup(char *name, size_t name_len);
+
+/* Fields of standard library tables whose values never change,
+ * 'table.field' is replaced by the value the handler pushes */
+struct mlua_icg_inline_constant
+{
+    const char *name;
+    const size_t name_len;
+
+    int (*func)(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block);
+};
+
+const struct mlua_icg_inline_constant *mlua_icg_inline_constant_lookup(char *name, size_t name_len);
+
+
+/* Names the program binds itself, a call or a constant reached
+ * through one of them is not the standard library and is not 
+ * inlined, scopes are not told apart */
+struct mlua_icg_inline_binding
+{
+    char *table;
+    size_t table_len;
+    /* NULL when the name 'table' itself is bound */
+    char *field;
+    size_t field_len;
+
+    struct mlua_icg_inline_binding *next;
+};
+
+/* Call of 'load' met while collecting, its chunk is collected 
+ * once the statements it was met in are done */
+struct mlua_icg_inline_load
+{
+    struct token *name;
+    struct mlua_ast_args *args;
+
+    struct mlua_icg_inline_load *next;
+};
+
+struct mlua_icg_inline_bindings
+{
+    struct mlua_icg_inline_binding *begin;
+    struct mlua_icg_inline_load *loads;
+
+    /* '_G[exp]' assigned or '_ENV' bound, any name may be */
+    int dynamic;
+};
+
+struct mlua_icg_inline_bindings *mlua_icg_inline_bindings_new(void);
+int mlua_icg_inline_bindings_destroy(struct mlua_icg_inline_bindings *bindings);
+/* Locals, parameters, loop variables, functions and 
+ * assignments of 'stmts' and of the functions in it, and of 
+ * the chunks it loads from constant strings, which are 
+ * parsed into 'chunks' */
+int mlua_icg_inline_bindings_collect(struct multiple_error *err, \
+        struct mlua_icg_inline_bindings *bindings, \
+        struct mlua_icg_chunk_map *chunks, \
+        struct mlua_ast_statement_list *stmts);
+/* 1 when 'name' or the table of 'table.field' is bound */
+int mlua_icg_inline_bindings_bound(struct mlua_icg_inline_bindings *bindings, \
+        char *name, size_t name_len);
+
+
+/* Arguments of an inlined call, 
+ * those written as literals are known at compile time */
+
+enum mlua_icg_inline_arg_type
+{
+    MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN = 0,
+    MLUA_ICG_INLINE_ARG_TYPE_NIL,
+    MLUA_ICG_INLINE_ARG_TYPE_FALSE,
+    MLUA_ICG_INLINE_ARG_TYPE_TRUE,
+    MLUA_ICG_INLINE_ARG_TYPE_INTEGER,
+    MLUA_ICG_INLINE_ARG_TYPE_FLOAT,
+    MLUA_ICG_INLINE_ARG_TYPE_STRING,
+};
+
+struct mlua_icg_inline_arg
+{
+    enum mlua_icg_inline_arg_type type;
+
+    /* NULL when the argument is a string written after the function */
+    struct mlua_ast_expression *exp;
+
+    int value_int;
+    double value_float;
+    /* Escape characters replaced */
+    char *str;
+    size_t len;
+};
+
+struct mlua_icg_inline_args
+{
+    struct mlua_icg_inline_arg *args;
+    size_t size;
+
+    /* Every argument is a constant */
+    int constant;
+    /* The last argument is a call and may yield multiple values */
+    int last_multiple;
+};
+
+/* Returns MLUA_ICG_INLINE_DECLINED for a table constructor */
+int mlua_icg_inline_args_new(struct multiple_error *err, \
+        struct mlua_icg_inline_args **args_out, \
+        struct mlua_ast_args *args);
+int mlua_icg_inline_args_destroy(struct mlua_icg_inline_args *args);
+
+/* 0 when the argument is a number with an integral value */
+int mlua_icg_inline_arg_to_int(struct mlua_icg_inline_arg *arg, int *value_out);
+/* 0 when the argument is a number */
+int mlua_icg_inline_arg_to_float(struct mlua_icg_inline_arg *arg, double *value_out);
+/* 0 when the argument is a string or a number, 
+ * numbers are written as 'tostring' in Lua does */
+int mlua_icg_inline_arg_to_str(struct mlua_icg_inline_arg *arg, \
+        char **str_out, size_t *len_out);
+
+/* Generate one value */
+int mlua_icg_inline_push_arg(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_icg_inline_arg *arg);
+/* Generate the arguments from 'idx' on which are not constants 
+ * and drop their values, the side effects are kept */
+int mlua_icg_inline_drop_args(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_icg_inline_args *args, size_t idx);
+int mlua_icg_inline_push_none(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block);
+int mlua_icg_inline_push_int(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        int value);
+int mlua_icg_inline_push_float(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        double value);
+int mlua_icg_inline_push_str(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        const char *str, size_t len);
+
+/* Growable buffer for strings built at compile time */
+struct mlua_icg_inline_buffer
+{
+    char *body;
+    size_t size;
+    size_t capacity;
+};
+
+int mlua_icg_inline_buffer_init(struct mlua_icg_inline_buffer *buffer);
+void mlua_icg_inline_buffer_uninit(struct mlua_icg_inline_buffer *buffer);
+int mlua_icg_inline_buffer_append(struct mlua_icg_inline_buffer *buffer, \
+        const char *str, size_t len);
 
 #endif
 
@@ -24,7 +24,10 @@
 #include "mlua_icg_stdlib.h"
 #include "mlua_icg_stdlib_math.h"
 #include "mlua_icg_stdlib_bitwise.h"
+#include "mlua_icg_stdlib_io.h"
 #include "mlua_icg_stdlib_os.h"
+#include "mlua_icg_stdlib_string.h"
+#include "mlua_icg_stdlib_table.h"
 
 
 /* Declarations */
@@ -287,11 +290,14 @@ int mlua_icg_stdlib_table_list_register(struct mlua_icg_stdlib_table_list *table
 }
 
 
-struct mlua_icg_add_built_in_table_handler mlua_icg_add_built_in_table_handlers[] =
+const struct mlua_icg_add_built_in_table_handler mlua_icg_add_built_in_table_handlers[] =
 {
-    {"math", 4, mlua_icg_add_built_in_field_handlers_math},
-    {"bit32", 4, mlua_icg_add_built_in_field_handlers_bitwise},
-    {"os", 2, mlua_icg_add_built_in_field_handlers_os},
-    {NULL, 0, NULL},
+    {"math", 4, mlua_icg_add_built_in_field_handlers_math, NULL},
+    {"bit32", 5, mlua_icg_add_built_in_field_handlers_bitwise, mlua_icg_add_built_in_hidden_handlers_bitwise},
+    {"io", 2, mlua_icg_add_built_in_field_handlers_io, NULL},
+    {"os", 2, mlua_icg_add_built_in_field_handlers_os, NULL},
+    {"string", 6, mlua_icg_add_built_in_field_handlers_string, NULL},
+    {"table", 5, mlua_icg_add_built_in_field_handlers_table, NULL},
+    {NULL, 0, NULL, NULL},
 };
 
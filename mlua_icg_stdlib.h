@@ -26,7 +26,6 @@
 #include "multiple_ir.h"
 
 #include "mlua_icg_stdlib_hdl.h"
-#include "mlua_icg_stdlib_math.h"
 
 struct mlua_icg_stdlib_field
 {
@@ -72,7 +71,7 @@ int mlua_icg_stdlib_table_list_register(struct mlua_icg_stdlib_table_list *table
         char *field_name, size_t field_name_len);
 
 
-extern struct mlua_icg_add_built_in_table_handler mlua_icg_add_built_in_table_handlers[];
+extern const struct mlua_icg_add_built_in_table_handler mlua_icg_add_built_in_table_handlers[];
 
 #endif
 
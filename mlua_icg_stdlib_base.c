@@ -0,0 +1,190 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : Base
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_err.h"
+#include "multiple_ir.h"
+
+#include "multiply.h"
+#include "multiply_assembler.h"
+
+#include "vm_opcode.h"
+#include "vm_types.h"
+#include "vm_predef.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_icg.h"
+#include "mlua_icg_fcb.h"
+#include "mlua_icg_context.h"
+#include "mlua_icg_expr.h"
+#include "mlua_icg_inline.h"
+#include "mlua_icg_chunk.h"
+
+#include "mlua_icg_stdlib_base.h"
+
+/* The only statement is 'return' of one function */
+static struct mlua_ast_expression *mlua_icg_inline_base_chunk_fundef( \
+        struct mlua_ast_program *program)
+{
+    struct mlua_ast_statement *stmt;
+    struct mlua_ast_expression_list *explist;
+
+    stmt = program->stmts->begin;
+    if ((stmt == NULL) || (stmt->next != NULL) || \
+            (stmt->type != MLUA_AST_STATEMENT_TYPE_RETURN))
+    { return NULL; }
+    explist = stmt->u.stmt_return->explist;
+    if ((explist == NULL) || (explist->size != 1) || \
+            (explist->begin->type != MLUA_AST_EXPRESSION_TYPE_FUNDEF))
+    { return NULL; }
+
+    return explist->begin;
+}
+
+/* Global holding the closure of a chunk, made once before the 
+ * program runs */
+#define MLUA_ICG_BASE_CHUNK_NAME "__chunk_%u"
+
+static int mlua_icg_inline_base_chunk_name(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        uint32_t *id_out, \
+        uint32_t block_index)
+{
+    char name[sizeof(MLUA_ICG_BASE_CHUNK_NAME) + 10];
+    int len;
+
+    len = sprintf(name, MLUA_ICG_BASE_CHUNK_NAME, (unsigned int)block_index);
+
+    return multiply_resource_get_id( \
+            err, \
+            context->icode, \
+            context->res_id, \
+            id_out, \
+            name, \
+            (size_t)len);
+}
+
+/* Generate the chunk as a function block of its own, its closure is 
+ * made before the program runs in a frame without locals, so no local 
+ * of the site loading it is in scope, the site only takes that closure */
+static int mlua_icg_inline_base_chunk(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        const char *source, size_t source_len)
+{
+    int ret = 0;
+    struct mlua_icg_chunk *chunk;
+    struct mlua_ast_expression *exp_fundef;
+    uint32_t id;
+
+    /* Every chunk compiled was parsed while collecting bindings */
+    if ((context->icg_fcb_block_chunks == NULL) || \
+            (context->chunks == NULL) || \
+            ((chunk = mlua_icg_chunk_map_lookup(context->chunks, source, source_len)) == NULL))
+    { MULTIPLE_ERROR_INTERNAL(); ret = -MULTIPLE_ERR_INTERNAL; goto fail; }
+
+    if (chunk->generated == 0)
+    {
+        /* An 'end' in the chunk closes the function early */
+        if ((exp_fundef = mlua_icg_inline_base_chunk_fundef(chunk->program)) == NULL)
+        {
+            multiple_error_update(err, -MULTIPLE_ERR_ICODEGEN, \
+                    "chunk given to \'load\' is not a block");
+            ret = -MULTIPLE_ERR_ICODEGEN;
+            goto fail;
+        }
+
+        /* Bodies are appended once generated, the chunk comes 
+         * after the functions nested in it */
+        if ((ret = mlua_icodegen_expression(err, \
+                        context, \
+                        context->icg_fcb_block_chunks, \
+                        exp_fundef)) != 0)
+        { goto fail; }
+        chunk->block_index = (uint32_t)(context->icg_fcb_block_list->size - 1);
+        chunk->generated = 1;
+
+        if ((ret = mlua_icg_inline_base_chunk_name(err, context, &id, chunk->block_index)) != 0)
+        { goto fail; }
+        if ((ret = mlua_icg_fcb_block_append_with_configure(context->icg_fcb_block_chunks, \
+                        OP_POPG, id)) != 0)
+        { goto fail; }
+    }
+
+    if ((ret = mlua_icg_inline_base_chunk_name(err, context, &id, chunk->block_index)) != 0)
+    { goto fail; }
+    if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, \
+                    OP_PUSH, id)) != 0)
+    { goto fail; }
+
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* load(chunk, chunkname, mode, env) */
+/* loadstring(chunk, chunkname) */
+/*
+ * Chunks written as constant strings are generated at compile time,
+ * evaluating one at run time only takes its closure. The others and 
+ * those with an environment are left to the procedures in the 
+ * function table, which report that they can not be compiled
+ */
+static int mlua_icg_inline_base_load(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *args = NULL;
+
+    if ((ret = mlua_icg_inline_args_new(err, &args, ast_args)) != 0) { goto fail; }
+    if ((args->size < 1) || (args->args[0].type != MLUA_ICG_INLINE_ARG_TYPE_STRING))
+    { ret = MLUA_ICG_INLINE_DECLINED; goto done; }
+    if ((args->size >= 4) && (args->args[3].type != MLUA_ICG_INLINE_ARG_TYPE_NIL))
+    { ret = MLUA_ICG_INLINE_DECLINED; goto done; }
+
+    /* Chunk names and modes are only evaluated */
+    if ((ret = mlua_icg_inline_drop_args(err, context, icg_fcb_block, args, 1)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_inline_base_chunk(err, context, icg_fcb_block, \
+                    args->args[0].str, args->args[0].len)) != 0)
+    { goto fail; }
+
+    goto done;
+fail:
+done:
+    if (args != NULL) mlua_icg_inline_args_destroy(args);
+    return ret;
+}
+
+const struct mlua_icg_inline_handler mlua_icg_inline_handlers_base[] =
+{
+    { "load", 4, mlua_icg_inline_base_load },
+    { "loadstring", 10, mlua_icg_inline_base_load },
+    { NULL, 0, NULL },
+};
+
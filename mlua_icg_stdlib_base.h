@@ -0,0 +1,31 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : Base
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#ifndef _MLUA_ICG_STDLIB_BASE_H_
+#define _MLUA_ICG_STDLIB_BASE_H_
+
+#include "mlua_icg_inline.h"
+
+/* Functions of the base library generated in place, 
+ * they are looked up by their plain names */
+extern const struct mlua_icg_inline_handler mlua_icg_inline_handlers_base[];
+
+#endif
+
@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <math.h>
 
 #include "multiple_err.h"
 #include "multiple_ir.h"
@@ -36,18 +38,772 @@
 #include "mlua_ast.h"
 #include "mlua_icg.h"
 #include "mlua_icg_fcb.h"
+#include "mlua_icg_stdlib_io.h"
+#include "mlua_icg_stdlib_bitwise.h"
 
+/* Name of the hidden global holding the word procedure */
+#define MLUA_ICG_STDLIB_BITWISE_WORD "__bit32_word"
+
+/* name = word(name), integers are words already and skip the call */
+#define MLUA_ICG_STDLIB_BITWISE_ASM_WORD(name, lbl) \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP       , OP_TYPE    , \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0, \
+    MULTIPLY_ASM_OP       , OP_TYPE    , \
+    MULTIPLY_ASM_OP       , OP_EQ      , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_BITWISE_WORD, \
+    MULTIPLY_ASM_OP       , OP_SLV     , \
+    MULTIPLY_ASM_OP       , OP_FUNCMK  , \
+    MULTIPLY_ASM_OP       , OP_CALLC   , \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , name, \
+    MULTIPLY_ASM_LABEL    , lbl
+
+/* result = value >> disp without sign fill, for disp in 0..31 */
+#define MLUA_ICG_STDLIB_BITWISE_ASM_SHR_LOGICAL(value, disp, result, lbl) \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , value, \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , result, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , disp, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0, \
+    MULTIPLY_ASM_OP       , OP_EQ      , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , value, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_SHR     , \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483647, \
+    MULTIPLY_ASM_OP       , OP_ANDA    , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , disp, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_SUB     , \
+    MULTIPLY_ASM_OP       , OP_SHR     , \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , result, \
+    MULTIPLY_ASM_LABEL    , lbl
+
+/* return name as an unsigned number, negative words become floats */
+#define MLUA_ICG_STDLIB_BITWISE_ASM_RESULT(name, lbl) \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0, \
+    MULTIPLY_ASM_OP       , OP_GE      , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0, \
+    MULTIPLY_ASM_OP       , OP_TYPEUP  , \
+    MULTIPLY_ASM_OP       , OP_DROP    , \
+    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4294967296.0, \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP       , OP_RETURN  , \
+    MULTIPLY_ASM_LABEL    , lbl, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP       , OP_RETURN
+
+/* word(x) */
+/*
+ * def word(x)
+ *     u = floor(x) - floor(x / 2^32) * 2^32
+ *     if u >= 2^31 then u = u - 2^32 end
+ *     return int(u)
+ * end
+ *
+ * Operands are worked on as 32-bit integers, which the VM's bitwise
+ * opcodes take directly. Integers already are, the other numbers are
+ * taken modulo 2^32 by this procedure, created once in the prologue
+ * and stored in a hidden global
+ */
+static int mlua_icg_add_built_in_procs_bitwise_word( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_ZERO = 0, LBL_Q_POSITIVE = 1, LBL_Q_FLOOR = 2;
+    const int LBL_FLOOR = 3, LBL_LOW = 4;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4294967296.0,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "q",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "q",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ZERO,
+                    /* q = floor(x / 2^32) */
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "q",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_Q_POSITIVE,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)-4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_LABEL    , LBL_Q_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "q",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "q",
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_Q_FLOOR,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_LABEL    , LBL_Q_FLOOR,
+                    /* u = floor(x - q * 2^32) */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4294967296.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "u",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "u",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "u",
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FLOOR,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_LABEL    , LBL_FLOOR  ,
+                    /* Upper half of the range wraps to negative words */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2147483648.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_LOW,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4294967296.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_LABEL    , LBL_LOW    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    /* Multiples of 2^32, infinities and nan */
+                    MULTIPLY_ASM_LABEL    , LBL_ZERO   ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* Folds the words of all arguments with 'opcode', starting from 'initial' */
+static int mlua_icg_stdlib_bitwise_asm_fold( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id, \
+        uint32_t opcode, int initial, int test)
+{
+    int ret = 0;
+    const int LBL_HEAD = 0, LBL_TAIL = 1, LBL_WORD = 2, LBL_RESULT = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , initial,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "idx",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "idx",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "idx",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , opcode     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "idx",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "idx",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+
+    if (test != 0)
+    {
+        if ((ret = multiply_asm(err, icode, res_id, 
+                        MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                        MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                        MULTIPLY_ASM_OP       , OP_NE      ,
+                        MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                        MULTIPLY_ASM_FINISH)) != 0)
+        { goto fail; } 
+    }
+    else
+    {
+        if ((ret = multiply_asm(err, icode, res_id, 
+                        MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+
+                        MULTIPLY_ASM_FINISH)) != 0)
+        { goto fail; } 
+    }
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* arshift(x, disp) */
+/*
+ * def arshift(x, disp)
+ *     if disp < 0 then return lshift(x, -disp) end
+ *     if disp > 31 then disp = 31 end
+ *     if x < 0 then return ~(~x >> disp) end
+ *     return x >> disp
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_arshift( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_WORD = 0, LBL_RIGHT = 1, LBL_NEGATIVE = 2, LBL_LEFT = 3;
+    const int LBL_DONE = 4, LBL_RESULT = 5;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "disp",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_LEFT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 31,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_RIGHT,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 31,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+                    MULTIPLY_ASM_LABEL    , LBL_RIGHT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NEGATIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_SHR     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_DONE,
+                    MULTIPLY_ASM_LABEL    , LBL_NEGATIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_SHR     ,
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_DONE,
+                    /* Negative displacements shift to the left */
+                    MULTIPLY_ASM_LABEL    , LBL_LEFT   ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , -31,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* band(...) */
+/*
+ * def band(...)
+ *     r = ~0
+ *     for x in ... do r = r & x end
+ *     return r
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_band( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_fold(err, icode, res_id, \
+            OP_ANDA, -1, 0);
+}
+
+/* bnot(x) */
+/*
+ * def bnot(x)
+ *     return ~x
+ * end
+ */
 static int mlua_icg_add_built_in_procs_bitwise_bnot( \
         struct multiple_error *err, \
         struct multiple_ir *icode, \
         struct multiply_resource_id_pool *res_id)
 {
     int ret = 0;
+    const int LBL_WORD = 0, LBL_RESULT = 1;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* bor(...) */
+/*
+ * def bor(...)
+ *     r = 0
+ *     for x in ... do r = r | x end
+ *     return r
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_bor( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_fold(err, icode, res_id, \
+            OP_ORA, 0, 0);
+}
+
+/* btest(...) */
+/*
+ * def btest(...)
+ *     return band(...) ~= 0
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_btest( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_fold(err, icode, res_id, \
+            OP_ANDA, -1, 1);
+}
+
+/* bxor(...) */
+/*
+ * def bxor(...)
+ *     r = 0
+ *     for x in ... do r = r ^ x end
+ *     return r
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_bxor( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_fold(err, icode, res_id, \
+            OP_XORA, 0, 0);
+}
+
+/* extract(x, field [, width]) */
+/*
+ * def extract(x, field, width)
+ *     width = width or 1
+ *     check 0 <= field, 0 < width, field + width <= 32
+ *     return (x >>> field) & mask(width)
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_extract( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_WIDTH = 0, LBL_ARGS = 1, LBL_NEGATIVE = 2, LBL_NOT_POSITIVE = 3;
+    const int LBL_OUT_OF_RANGE = 4, LBL_WORD = 5, LBL_SHIFT = 6, LBL_MASK = 7;
+    const int LBL_RESULT = 8;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "field",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_WIDTH,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "width",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_WIDTH,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "width",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "field",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "width",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NEGATIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 32,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_OUT_OF_RANGE,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MLUA_ICG_STDLIB_BITWISE_ASM_SHR_LOGICAL("x", "field", "r", LBL_SHIFT),
+                    /* mask = ~(~0 << width), all bits for the full width */
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , -1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "mask",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 32,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MASK,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , -1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "mask",
+                    MULTIPLY_ASM_LABEL    , LBL_MASK   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mask",
+                    MULTIPLY_ASM_OP       , OP_ANDA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+                    MULTIPLY_ASM_LABEL    , LBL_NEGATIVE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #2 to 'extract' (field cannot be negative)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_POSITIVE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #3 to 'extract' (width must be positive)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_OUT_OF_RANGE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: trying to access non-existent bits\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* Rotates the word 'x' left by 'disp' % 32 */
+static int mlua_icg_stdlib_bitwise_asm_rotate( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id, \
+        int right)
+{
+    int ret = 0;
+    const int LBL_WORD = 0, LBL_SHIFT = 1, LBL_DONE = 2, LBL_RESULT = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "disp",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+
+    if (right != 0)
+    {
+        if ((ret = multiply_asm(err, icode, res_id, 
+                        MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                        MULTIPLY_ASM_OP       , OP_NEG     ,
+                        MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+
+                        MULTIPLY_ASM_FINISH)) != 0)
+        { goto fail; } 
+    }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 31,
+                    MULTIPLY_ASM_OP       , OP_ANDA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 32,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "rest",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_SHR_LOGICAL("x", "rest", "r", LBL_SHIFT),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_ORA     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* lrotate(x, disp) */
+/*
+ * def lrotate(x, disp)
+ *     disp = disp & 31
+ *     return (x << disp) | (x >>> (32 - disp))
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_lrotate( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_rotate(err, icode, res_id, 0);
+}
+
+/* Shifts the word 'x' by 'disp', to the left when 'left' is set,
+ * negative displacements shift the other way */
+static int mlua_icg_stdlib_bitwise_asm_shift( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id, \
+        int left)
+{
+    int ret = 0;
+    const int LBL_WORD = 0, LBL_RIGHT = 1, LBL_SHIFT = 2;
+    const int LBL_DONE = 3, LBL_RESULT = 4;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "disp",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+
+    if (left == 0)
+    {
+        if ((ret = multiply_asm(err, icode, res_id, 
+                        MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                        MULTIPLY_ASM_OP       , OP_NEG     ,
+                        MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+
+                        MULTIPLY_ASM_FINISH)) != 0)
+        { goto fail; } 
+    }
+
+    /* Displacements of 32 bits and more shift everything out */
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD),
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_RIGHT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 31,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_DONE,
+                    MULTIPLY_ASM_LABEL    , LBL_RIGHT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "disp",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "disp",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 31,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_SHR_LOGICAL("x", "disp", "r", LBL_SHIFT),
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* lshift(x, disp) */
+/*
+ * def lshift(x, disp)
+ *     if disp < 0 then return rshift(x, -disp) end
+ *     if disp > 31 then return 0 end
+ *     return x << disp
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_lshift( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_shift(err, icode, res_id, 1);
+}
+
+/* replace(x, v, field [, width]) */
+/*
+ * def replace(x, v, field, width)
+ *     width = width or 1
+ *     check 0 <= field, 0 < width, field + width <= 32
+ *     m = mask(width)
+ *     return (x & ~(m << field)) | ((v & m) << field)
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_replace( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_WIDTH = 0, LBL_ARGS = 1, LBL_NEGATIVE = 2, LBL_NOT_POSITIVE = 3;
+    const int LBL_OUT_OF_RANGE = 4, LBL_WORD_X = 5, LBL_WORD_V = 6, LBL_MASK = 7;
+    const int LBL_RESULT = 8;
 
     if ((ret = multiply_asm(err, icode, res_id, 
-                    MULTIPLY_ASM_OP     , OP_ARGCS   ,
-                    MULTIPLY_ASM_OP     , OP_NOTA    , 
-                    MULTIPLY_ASM_OP     , OP_RETURN  , 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "field",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_WIDTH,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "width",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_WIDTH,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "width",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "field",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "width",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NEGATIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 32,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_OUT_OF_RANGE,
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("x", LBL_WORD_X),
+                    MLUA_ICG_STDLIB_BITWISE_ASM_WORD("v", LBL_WORD_V),
+                    /* mask = ~(~0 << width), all bits for the full width */
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , -1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "mask",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 32,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MASK,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , -1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "width",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "mask",
+                    MULTIPLY_ASM_LABEL    , LBL_MASK   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mask",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP       , OP_NOTA    ,
+                    MULTIPLY_ASM_OP       , OP_ANDA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mask",
+                    MULTIPLY_ASM_OP       , OP_ANDA    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "field",
+                    MULTIPLY_ASM_OP       , OP_SHL     ,
+                    MULTIPLY_ASM_OP       , OP_ORA     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MLUA_ICG_STDLIB_BITWISE_ASM_RESULT("r", LBL_RESULT),
+                    MULTIPLY_ASM_LABEL    , LBL_NEGATIVE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #3 to 'replace' (field cannot be negative)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_POSITIVE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #4 to 'replace' (width must be positive)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_OUT_OF_RANGE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: trying to access non-existent bits\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
 
                     MULTIPLY_ASM_FINISH)) != 0)
     { goto fail; } 
@@ -57,11 +813,403 @@ done:
     return ret;
 }
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[];
+/* rrotate(x, disp) */
+/*
+ * def rrotate(x, disp)
+ *     return lrotate(x, -disp)
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_rrotate( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_rotate(err, icode, res_id, 1);
+}
+
+/* rshift(x, disp) */
+/*
+ * def rshift(x, disp)
+ *     if disp < 0 then return lshift(x, -disp) end
+ *     if disp > 31 then return 0 end
+ *     return x >>> disp
+ * end
+ */
+static int mlua_icg_add_built_in_procs_bitwise_rshift( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    return mlua_icg_stdlib_bitwise_asm_shift(err, icode, res_id, 0);
+}
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[];
 
-struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[] =
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[] =
 {
+    { MLUA_BUILT_IN_METHOD, "arshift", 7, mlua_icg_add_built_in_procs_bitwise_arshift },
+    { MLUA_BUILT_IN_METHOD, "band", 4, mlua_icg_add_built_in_procs_bitwise_band },
     { MLUA_BUILT_IN_METHOD, "bnot", 4, mlua_icg_add_built_in_procs_bitwise_bnot },
+    { MLUA_BUILT_IN_METHOD, "bor", 3, mlua_icg_add_built_in_procs_bitwise_bor },
+    { MLUA_BUILT_IN_METHOD, "btest", 5, mlua_icg_add_built_in_procs_bitwise_btest },
+    { MLUA_BUILT_IN_METHOD, "bxor", 4, mlua_icg_add_built_in_procs_bitwise_bxor },
+    { MLUA_BUILT_IN_METHOD, "extract", 7, mlua_icg_add_built_in_procs_bitwise_extract },
+    { MLUA_BUILT_IN_METHOD, "lrotate", 7, mlua_icg_add_built_in_procs_bitwise_lrotate },
+    { MLUA_BUILT_IN_METHOD, "lshift", 6, mlua_icg_add_built_in_procs_bitwise_lshift },
+    { MLUA_BUILT_IN_METHOD, "replace", 7, mlua_icg_add_built_in_procs_bitwise_replace },
+    { MLUA_BUILT_IN_METHOD, "rrotate", 7, mlua_icg_add_built_in_procs_bitwise_rrotate },
+    { MLUA_BUILT_IN_METHOD, "rshift", 6, mlua_icg_add_built_in_procs_bitwise_rshift },
+    { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
+};
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_hidden_handlers_bitwise[];
+
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_hidden_handlers_bitwise[] =
+{
+    { MLUA_BUILT_IN_METHOD, MLUA_ICG_STDLIB_BITWISE_WORD, 12, mlua_icg_add_built_in_procs_bitwise_word },
     { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
 };
 
+
+/* Calls with constant arguments are folded at compile time */
+
+#define MLUA_ICG_STDLIB_BITWISE_INLINE_ARGS_MAX 16
+
+/* x mod 2^32, the unsigned form of the procedures' words */
+static uint32_t mlua_icg_inline_bitwise_unsigned(double value)
+{
+    /* Infinities and nan */
+    if (!(fabs(value) < HUGE_VAL)) return 0;
+    value = fmod(floor(value), 4294967296.0);
+    if (value < 0) value += 4294967296.0;
+    return (uint32_t)value;
+}
+
+/* Integral part of a displacement, those beyond 32 bits
+ * all shift everything out */
+static int mlua_icg_inline_bitwise_disp(double value)
+{
+    if (value <= -64.0) return -64;
+    if (value >= 64.0) return 64;
+    return (int)value;
+}
+
+static uint32_t mlua_icg_inline_bitwise_shift(uint32_t value, int disp)
+{
+    if ((disp <= -32) || (disp >= 32)) return 0;
+    return (disp >= 0) ? (value << disp) : (value >> (-disp));
+}
+
+static uint32_t mlua_icg_inline_bitwise_rotate(uint32_t value, int disp)
+{
+    disp = ((disp % 32) + 32) % 32;
+    if (disp == 0) return value;
+    return (value << disp) | (value >> (32 - disp));
+}
+
+static uint32_t mlua_icg_inline_bitwise_mask(int width)
+{
+    return (width >= 32) ? 0xffffffffU : (((uint32_t)1 << width) - 1);
+}
+
+/* Values of 'size_min' to 'size_max' constant numbers */
+static int mlua_icg_inline_bitwise_args(struct multiple_error *err, \
+        struct mlua_ast_args *ast_args, \
+        double *values, size_t *size_out, \
+        size_t size_min, size_t size_max)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *args = NULL;
+    size_t idx;
+
+    if ((ret = mlua_icg_inline_args_new(err, &args, ast_args)) != 0) { goto fail; }
+    if ((args->constant == 0) || \
+            (args->size < size_min) || \
+            (args->size > size_max))
+    { ret = MLUA_ICG_INLINE_DECLINED; goto fail; }
+    for (idx = 0; idx != args->size; idx++)
+    {
+        if (mlua_icg_inline_arg_to_float(&args->args[idx], &values[idx]) != 0)
+        { ret = MLUA_ICG_INLINE_DECLINED; goto fail; }
+    }
+    *size_out = args->size;
+
+    goto done;
+fail:
+done:
+    if (args != NULL) mlua_icg_inline_args_destroy(args);
+    return ret;
+}
+
+static int mlua_icg_inline_bitwise_push(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        uint32_t value)
+{
+    if (value < 0x80000000U)
+    {
+        return mlua_icg_inline_push_int(err, context, icg_fcb_block, (int)value);
+    }
+    return mlua_icg_inline_push_float(err, context, icg_fcb_block, (double)value);
+}
+
+static int mlua_icg_inline_bitwise_arshift(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[2];
+    size_t size;
+    uint32_t value;
+    int disp;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 2)) != 0)
+    { return ret; }
+    value = mlua_icg_inline_bitwise_unsigned(values[0]);
+    disp = mlua_icg_inline_bitwise_disp(values[1]);
+    if ((disp > 0) && ((value & 0x80000000U) != 0))
+    {
+        value = (disp >= 32) ? 0xffffffffU : \
+                ((value >> disp) | ~(0xffffffffU >> disp));
+    }
+    else
+    {
+        value = mlua_icg_inline_bitwise_shift(value, -disp);
+    }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, value);
+}
+
+/* 'band', 'bor', 'bxor' and 'btest' */
+static int mlua_icg_inline_bitwise_fold(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args, \
+        char op)
+{
+    int ret;
+    double values[MLUA_ICG_STDLIB_BITWISE_INLINE_ARGS_MAX];
+    size_t size, idx;
+    uint32_t value, result;
+    uint32_t id;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, \
+                    0, MLUA_ICG_STDLIB_BITWISE_INLINE_ARGS_MAX)) != 0)
+    { return ret; }
+    result = ((op == '&') || (op == 't')) ? 0xffffffffU : 0;
+    for (idx = 0; idx != size; idx++)
+    {
+        value = mlua_icg_inline_bitwise_unsigned(values[idx]);
+        switch (op)
+        {
+            case '|': result |= value; break;
+            case '^': result ^= value; break;
+            default: result &= value; break;
+        }
+    }
+
+    if (op == 't')
+    {
+        if (result != 0)
+        { ret = multiply_resource_get_true(err, context->icode, context->res_id, &id); }
+        else
+        { ret = multiply_resource_get_false(err, context->icode, context->res_id, &id); }
+        if (ret != 0) { return ret; }
+        return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_PUSH, id);
+    }
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, result);
+}
+
+static int mlua_icg_inline_bitwise_band(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    return mlua_icg_inline_bitwise_fold(err, context, icg_fcb_block, ast_args, '&');
+}
+
+static int mlua_icg_inline_bitwise_bnot(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[1];
+    size_t size;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 1, 1)) != 0)
+    { return ret; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            ~mlua_icg_inline_bitwise_unsigned(values[0]));
+}
+
+static int mlua_icg_inline_bitwise_bor(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    return mlua_icg_inline_bitwise_fold(err, context, icg_fcb_block, ast_args, '|');
+}
+
+static int mlua_icg_inline_bitwise_btest(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    return mlua_icg_inline_bitwise_fold(err, context, icg_fcb_block, ast_args, 't');
+}
+
+static int mlua_icg_inline_bitwise_bxor(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    return mlua_icg_inline_bitwise_fold(err, context, icg_fcb_block, ast_args, '^');
+}
+
+/* Field and width of 'extract' and 'replace',
+ * invalid ones are left to be reported at run time */
+static int mlua_icg_inline_bitwise_field(double field_value, double width_value, \
+        int *field_out, int *width_out)
+{
+    if ((field_value < 0.0) || (field_value >= 32.0) || \
+            (width_value < 1.0) || (width_value > 32.0))
+    { return -1; }
+    *field_out = (int)field_value;
+    *width_out = (int)width_value;
+    if (*field_out + *width_out > 32) return -1;
+
+    return 0;
+}
+
+static int mlua_icg_inline_bitwise_extract(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[3];
+    size_t size;
+    int field, width;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 3)) != 0)
+    { return ret; }
+    if (size == 2) values[2] = 1.0;
+    if (mlua_icg_inline_bitwise_field(values[1], values[2], &field, &width) != 0)
+    { return MLUA_ICG_INLINE_DECLINED; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            (mlua_icg_inline_bitwise_unsigned(values[0]) >> field) & \
+            mlua_icg_inline_bitwise_mask(width));
+}
+
+static int mlua_icg_inline_bitwise_lrotate(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[2];
+    size_t size;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 2)) != 0)
+    { return ret; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            mlua_icg_inline_bitwise_rotate(mlua_icg_inline_bitwise_unsigned(values[0]), \
+                mlua_icg_inline_bitwise_disp(values[1])));
+}
+
+static int mlua_icg_inline_bitwise_lshift(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[2];
+    size_t size;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 2)) != 0)
+    { return ret; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            mlua_icg_inline_bitwise_shift(mlua_icg_inline_bitwise_unsigned(values[0]), \
+                mlua_icg_inline_bitwise_disp(values[1])));
+}
+
+static int mlua_icg_inline_bitwise_replace(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[4];
+    size_t size;
+    int field, width;
+    uint32_t mask;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 3, 4)) != 0)
+    { return ret; }
+    if (size == 3) values[3] = 1.0;
+    if (mlua_icg_inline_bitwise_field(values[2], values[3], &field, &width) != 0)
+    { return MLUA_ICG_INLINE_DECLINED; }
+    mask = mlua_icg_inline_bitwise_mask(width);
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            (mlua_icg_inline_bitwise_unsigned(values[0]) & ~(mask << field)) | \
+            ((mlua_icg_inline_bitwise_unsigned(values[1]) & mask) << field));
+}
+
+static int mlua_icg_inline_bitwise_rrotate(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[2];
+    size_t size;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 2)) != 0)
+    { return ret; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            mlua_icg_inline_bitwise_rotate(mlua_icg_inline_bitwise_unsigned(values[0]), \
+                -mlua_icg_inline_bitwise_disp(values[1])));
+}
+
+static int mlua_icg_inline_bitwise_rshift(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret;
+    double values[2];
+    size_t size;
+
+    if ((ret = mlua_icg_inline_bitwise_args(err, ast_args, values, &size, 2, 2)) != 0)
+    { return ret; }
+
+    return mlua_icg_inline_bitwise_push(err, context, icg_fcb_block, \
+            mlua_icg_inline_bitwise_shift(mlua_icg_inline_bitwise_unsigned(values[0]), \
+                -mlua_icg_inline_bitwise_disp(values[1])));
+}
+
+const struct mlua_icg_inline_handler mlua_icg_inline_handlers_bitwise[] =
+{
+    { "bit32.arshift", 13, mlua_icg_inline_bitwise_arshift },
+    { "bit32.band", 10, mlua_icg_inline_bitwise_band },
+    { "bit32.bnot", 10, mlua_icg_inline_bitwise_bnot },
+    { "bit32.bor", 9, mlua_icg_inline_bitwise_bor },
+    { "bit32.btest", 11, mlua_icg_inline_bitwise_btest },
+    { "bit32.bxor", 10, mlua_icg_inline_bitwise_bxor },
+    { "bit32.extract", 13, mlua_icg_inline_bitwise_extract },
+    { "bit32.lrotate", 13, mlua_icg_inline_bitwise_lrotate },
+    { "bit32.lshift", 12, mlua_icg_inline_bitwise_lshift },
+    { "bit32.replace", 13, mlua_icg_inline_bitwise_replace },
+    { "bit32.rrotate", 13, mlua_icg_inline_bitwise_rrotate },
+    { "bit32.rshift", 12, mlua_icg_inline_bitwise_rshift },
+    { NULL, 0, NULL },
+};
+
@@ -22,8 +22,13 @@
 #define _MLUA_ICG_STDLIB_BITWISE_H_
 
 #include "mlua_icg_stdlib_hdl.h"
+#include "mlua_icg_inline.h"
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[];
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_bitwise[];
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_hidden_handlers_bitwise[];
+
+extern const struct mlua_icg_inline_handler mlua_icg_inline_handlers_bitwise[];
 
 #endif
 
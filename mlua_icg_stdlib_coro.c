@@ -117,9 +117,9 @@ done:
     return ret;
 }
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_coroutine[];
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_coroutine[];
 
-struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_coroutine[] =
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_coroutine[] =
 {
     { MLUA_BUILT_IN_METHOD, "create", 6, mlua_icg_add_built_in_procs_coroutine_create },
     { MLUA_BUILT_IN_METHOD, "status", 6, mlua_icg_add_built_in_procs_coroutine_status },
@@ -23,7 +23,7 @@
 
 #include "mlua_icg_stdlib_hdl.h"
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_corotine[];
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_coroutine[];
 
 #endif
 
@@ -25,11 +25,11 @@
 
 /* Field Handler */
 
-struct mlua_icg_add_built_in_field_handler *mlua_icg_add_built_in_field_handler_lookup( \
-        struct mlua_icg_add_built_in_field_handler *field_handler_start, \
+const struct mlua_icg_add_built_in_field_handler *mlua_icg_add_built_in_field_handler_lookup( \
+        const struct mlua_icg_add_built_in_field_handler *field_handler_start, \
         char *name, size_t len)
 {
-    struct mlua_icg_add_built_in_field_handler *field_handler_cur;
+    const struct mlua_icg_add_built_in_field_handler *field_handler_cur;
 
     field_handler_cur = field_handler_start;
     while (field_handler_cur != NULL)
@@ -47,11 +47,11 @@ struct mlua_icg_add_built_in_field_handler *mlua_icg_add_built_in_field_handler_
     return NULL;
 }
 
-struct mlua_icg_add_built_in_table_handler *mlua_icg_add_built_in_table_handler_lookup( \
-        struct mlua_icg_add_built_in_table_handler *table_handler_start, \
+const struct mlua_icg_add_built_in_table_handler *mlua_icg_add_built_in_table_handler_lookup( \
+        const struct mlua_icg_add_built_in_table_handler *table_handler_start, \
         char *name, size_t len)
 {
-    struct mlua_icg_add_built_in_table_handler *table_handler_cur;
+    const struct mlua_icg_add_built_in_table_handler *table_handler_cur;
 
     table_handler_cur = table_handler_start;
     while (table_handler_cur != NULL)
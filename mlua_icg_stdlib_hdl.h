@@ -48,8 +48,8 @@ struct mlua_icg_add_built_in_field_handler
             struct multiply_resource_id_pool *res_id);
 };
 
-struct mlua_icg_add_built_in_field_handler *mlua_icg_add_built_in_field_handler_lookup( \
-        struct mlua_icg_add_built_in_field_handler *field_handler_start, \
+const struct mlua_icg_add_built_in_field_handler *mlua_icg_add_built_in_field_handler_lookup( \
+        const struct mlua_icg_add_built_in_field_handler *field_handler_start, \
         char *name, size_t len);
 
 
@@ -59,11 +59,13 @@ struct mlua_icg_add_built_in_table_handler
 {
     const char *name;
     const size_t name_len;
-    struct mlua_icg_add_built_in_field_handler *field_handler;
+    const struct mlua_icg_add_built_in_field_handler *field_handler;
+    /* Procedures shared by the fields, stored in hidden globals */
+    const struct mlua_icg_add_built_in_field_handler *hidden_handler;
 };
 
-struct mlua_icg_add_built_in_table_handler *mlua_icg_add_built_in_table_handler_lookup( \
-        struct mlua_icg_add_built_in_table_handler *table_handler_start, \
+const struct mlua_icg_add_built_in_table_handler *mlua_icg_add_built_in_table_handler_lookup( \
+        const struct mlua_icg_add_built_in_table_handler *table_handler_start, \
         char *name, size_t len);
 
 
@@ -0,0 +1,302 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : IO
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_err.h"
+#include "multiple_ir.h"
+
+#include "multiply.h"
+#include "multiply_assembler.h"
+
+#include "vm_opcode.h"
+#include "vm_types.h"
+#include "vm_predef.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_icg.h"
+#include "mlua_icg_fcb.h"
+#include "mlua_icg_stdlib_table.h"
+#include "mlua_icg_stdlib_io.h"
+
+/* Standard output goes through a table of pieces shared with 'print'.
+ * It is line buffered by default, every call is written out with one
+ * OP_PRINT. "full" mode saves OP_PRINT calls until the pending bytes
+ * reach the limit, on 'flush' and when the program ends. The pieces
+ * are joined pairwise only then, so nothing pending is copied again
+ * on every write.
+ *
+ * The VM reads no input and opens no files, there is no 'read',
+ * 'lines' or 'open' */
+
+/* stdout_flush() */
+/*
+ * def stdout_flush()
+ *     if count == 0 then return end
+ *     write(table.concat(buffer, "", 1, count))
+ *     buffer = {}; count = 0; pending = 0
+ * end
+ *
+ * Created once before the main chunk runs and stored in a hidden
+ * global, MLUA_ICG_STDLIB_IO_ASM_FLUSH calls it
+ */
+int mlua_icg_add_built_in_procs_io_stdout_flush(struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_MERGE = 0, LBL_PAIR = 1, LBL_ODD = 2, LBL_STORE = 3;
+    const int LBL_ROUND = 4, LBL_DONE = 5, LBL_EMPTY = 6;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_COUNT,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "m",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "m",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_BUFFER,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "parts",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sep",
+                    MLUA_ICG_STDLIB_TABLE_ASM_JOIN(LBL_MERGE, LBL_PAIR, LBL_ODD, \
+                            LBL_STORE, LBL_ROUND, LBL_DONE),
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP_RAW   , OP_HASHMK  , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_BUFFER,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_COUNT,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_PENDING,
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* flush() */
+/*
+ * def flush()
+ *     stdout_flush()
+ * end
+ */
+static int mlua_icg_add_built_in_procs_io_flush( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* setvbuf(mode, size) */
+/*
+ * def setvbuf(mode, size)
+ *     if mode ~= "no" and mode ~= "full" and mode ~= "line" then error end
+ *     stdout_flush()
+ *     buffering = mode
+ *     limit = size or MLUA_ICG_STDLIB_IO_BUFFER_SIZE
+ *     return true
+ * end
+ *
+ * Files can not be opened, so the buffering of standard output is
+ * set on the library instead of on 'io.stdout'
+ */
+static int mlua_icg_add_built_in_procs_io_setvbuf( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_MODE = 0, LBL_HAS_SIZE = 1, LBL_SIZE = 2;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "mode",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mode",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "no",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MODE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mode",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "full",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MODE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mode",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "line",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MODE,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #1 to 'setvbuf' (invalid option)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_MODE   ,
+
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "mode",
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_MODE,
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_SIZE,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , MLUA_ICG_STDLIB_IO_BUFFER_SIZE,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SIZE,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_SIZE,
+                    MULTIPLY_ASM_OP       , OP_ARGCS   ,
+                    MULTIPLY_ASM_LABEL    , LBL_SIZE   ,
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_LIMIT,
+                    MULTIPLY_ASM_OP_TRUE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* write(...) */
+/*
+ * def write(...)
+ *     for each v in ... do
+ *         if type(v) ~= "string" and type(v) ~= "number" then error end
+ *         append(tostring(v))
+ *     end
+ *     if buffering ~= "full" or pending >= limit then stdout_flush() end
+ * end
+ *
+ * Buffering "line" writes out at the end of every call, the pieces 
+ * of one call still go out together. There is no file object to
+ * return, so nil is returned and calls can not be chained
+ */
+static int mlua_icg_add_built_in_procs_io_write( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HEAD = 0, LBL_TAIL = 1, LBL_NUMBER = 2;
+    const int LBL_STRING = 3, LBL_FLUSH = 4, LBL_DONE = 5;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_STRING,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NUMBER,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NUMBER,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument to 'write' (string expected)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+                    MULTIPLY_ASM_LABEL    , LBL_NUMBER ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "v",
+                    MULTIPLY_ASM_LABEL    , LBL_STRING ,
+                    MLUA_ICG_STDLIB_IO_ASM_APPEND("v"),
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_MODE,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "full",
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FLUSH,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_PENDING,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_LIMIT,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_LABEL    , LBL_FLUSH  ,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_io[];
+
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_io[] =
+{
+    { MLUA_BUILT_IN_METHOD, "flush", 5, mlua_icg_add_built_in_procs_io_flush },
+    { MLUA_BUILT_IN_METHOD, "setvbuf", 7, mlua_icg_add_built_in_procs_io_setvbuf },
+    { MLUA_BUILT_IN_METHOD, "write", 5, mlua_icg_add_built_in_procs_io_write },
+    { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
+};
+
@@ -0,0 +1,73 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : IO
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#ifndef _MLUA_ICG_STDLIB_IO_H_
+#define _MLUA_ICG_STDLIB_IO_H_
+
+#include "mlua_icg_stdlib_hdl.h"
+
+/* Globals of the buffered standard output, shared by 'io.write'
+ * and 'print', set up before the main chunk runs. Pending output is
+ * a table of pieces, joined once when it is written out */
+#define MLUA_ICG_STDLIB_IO_BUFFER "__io_stdout_buffer"
+#define MLUA_ICG_STDLIB_IO_COUNT "__io_stdout_count"
+#define MLUA_ICG_STDLIB_IO_PENDING "__io_stdout_pending"
+#define MLUA_ICG_STDLIB_IO_MODE "__io_stdout_mode"
+#define MLUA_ICG_STDLIB_IO_LIMIT "__io_stdout_limit"
+#define MLUA_ICG_STDLIB_IO_FLUSH "__io_stdout_flush"
+
+/* Bytes pending in "full" mode before they are written out */
+#define MLUA_ICG_STDLIB_IO_BUFFER_SIZE 8192
+
+/* Rows writing out what is pending, every OP_HALT and the end of the
+ * main chunk come after them */
+#define MLUA_ICG_STDLIB_IO_ASM_FLUSH \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_FLUSH, \
+    MULTIPLY_ASM_OP       , OP_SLV     , \
+    MULTIPLY_ASM_OP       , OP_FUNCMK  , \
+    MULTIPLY_ASM_OP       , OP_CALLC   , \
+    MULTIPLY_ASM_OP       , OP_DROP
+
+/* Rows appending the string 'name' to what is pending */
+#define MLUA_ICG_STDLIB_IO_ASM_APPEND(name) \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_COUNT, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP       , OP_DUP     , \
+    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_COUNT, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_BUFFER, \
+    MULTIPLY_ASM_OP       , OP_HASHADD , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_IO_PENDING, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , name, \
+    MULTIPLY_ASM_OP       , OP_SIZE    , \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_IO_PENDING
+
+/* The procedure stored in MLUA_ICG_STDLIB_IO_FLUSH */
+int mlua_icg_add_built_in_procs_io_stdout_flush(struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id);
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_io[];
+
+#endif
+
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include "multiple_err.h"
 #include "multiple_ir.h"
@@ -35,6 +36,8 @@
 #include "mlua_ast.h"
 #include "mlua_icg.h"
 #include "mlua_icg_fcb.h"
+#include "mlua_icg_stdlib_io.h"
+#include "mlua_icg_stdlib_math.h"
 
 
 static int mlua_icg_add_built_in_procs_math_abs( \
@@ -57,6 +60,276 @@ done:
     return ret;
 }
 
+/* atan(y [, x]) and atan2(y, x) */
+/*
+ * def atan2(y, x)
+ *     ay, ax = abs(y), abs(x)
+ *     if ax == 0 and ay == 0 then return 0 end
+ *     if ay > ax then t = ax / ay else t = ay / ax end
+ *     if t > tan(pi / 12) then t = (t * sqrt(3) - 1) / (t + sqrt(3)); r = pi / 6 else r = 0 end
+ *     r = r + t - t^3 / 3 + t^5 / 5 - ...
+ *     if ay > ax then r = pi / 2 - r end
+ *     if x < 0 then r = pi - r end
+ *     if y < 0 then r = -r end
+ *     return r
+ * end
+ *
+ * After the reductions |t| <= tan(pi / 12), 12 terms of the series
+ * are below 1e-15
+ */
+static int mlua_icg_add_built_in_procs_math_atan2( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_X = 0, LBL_ARGS = 1, LBL_NOT_ZERO = 2, LBL_RATIO = 3;
+    const int LBL_SMALL = 4, LBL_SERIES = 5, LBL_SERIES_DONE = 6;
+    const int LBL_NOT_SWAPPED = 7, LBL_X_POSITIVE = 8, LBL_Y_POSITIVE = 9, LBL_TERM = 10;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "y",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_X,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_X  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    /* As floats */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "y",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "y",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "ay",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "ax",
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ay",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_ZERO,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_ZERO,
+
+                    /* t in [0, 1] */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ay",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "swapped",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_RATIO,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ay",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SMALL,
+                    MULTIPLY_ASM_LABEL    , LBL_RATIO  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ay",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+
+                    /* t in [0, tan(pi / 12)] */
+                    MULTIPLY_ASM_LABEL    , LBL_SMALL  ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.26794919243112270,
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SERIES,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.7320508075688772,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.7320508075688772,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.52359877559829887,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+
+                    /* r = r + t - t^3 / 3 + t^5 / 5 - ... */
+                    MULTIPLY_ASM_LABEL    , LBL_SERIES ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t2",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_LABEL    , LBL_TERM,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)23.0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SERIES_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t2",
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_TERM,
+                    MULTIPLY_ASM_LABEL    , LBL_SERIES_DONE,
+
+                    /* Back to the quadrant */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "swapped",
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_SWAPPED,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.5707963267948966,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_SWAPPED,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_X_POSITIVE,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)3.1415926535897932,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_X_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "y",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_Y_POSITIVE,
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_LABEL    , LBL_Y_POSITIVE,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* ceil(x) */
+/*
+ * def ceil(x)
+ *     if x is an integer or x ~= x then return x end
+ *     if abs(x) < 2^31 - 1 then
+ *         t = int(x)
+ *     elseif abs(x) < 2^52 then
+ *         c = x < 0 and -2^52 or 2^52
+ *         t = (x + c) - c
+ *     else
+ *         return x
+ *     end
+ *     if t < x then t = t + 1 end
+ *     return t
+ * end
+ *
+ * Integers are returned when representable, adding and subtracting
+ * 2^52 rounds the larger floats to an integral value
+ */
+static int mlua_icg_add_built_in_procs_math_ceil( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_SAME = 0, LBL_EXACT = 1, LBL_LARGE = 2, LBL_ADJUST = 3, LBL_POSITIVE = 4;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SAME,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "ax",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2147483647.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_LARGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ADJUST,
+
+                    /* Beyond 2^52 every float is integral, nan falls here too */
+                    MULTIPLY_ASM_LABEL    , LBL_LARGE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SAME,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)-4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_LABEL    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+
+                    MULTIPLY_ASM_LABEL    , LBL_ADJUST ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EXACT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_EXACT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_SAME   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
 static int mlua_icg_add_built_in_procs_math_cos( \
         struct multiple_error *err, \
         struct multiple_ir *icode, \
@@ -97,6 +370,768 @@ done:
     return ret;
 }
 
+/* floor(x) */
+/*
+ * def floor(x)
+ *     if x is an integer or x ~= x then return x end
+ *     if abs(x) < 2^31 - 1 then
+ *         t = int(x)
+ *     elseif abs(x) < 2^52 then
+ *         c = x < 0 and -2^52 or 2^52
+ *         t = (x + c) - c
+ *     else
+ *         return x
+ *     end
+ *     if t > x then t = t - 1 end
+ *     return t
+ * end
+ *
+ * Integers are returned when representable, adding and subtracting
+ * 2^52 rounds the larger floats to an integral value
+ */
+static int mlua_icg_add_built_in_procs_math_floor( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_SAME = 0, LBL_EXACT = 1, LBL_LARGE = 2, LBL_ADJUST = 3, LBL_POSITIVE = 4;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SAME,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "ax",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2147483647.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_LARGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ADJUST,
+
+                    /* Beyond 2^52 every float is integral, nan falls here too */
+                    MULTIPLY_ASM_LABEL    , LBL_LARGE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ax",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SAME,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)-4503599627370496.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "c",
+                    MULTIPLY_ASM_LABEL    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "c",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+
+                    MULTIPLY_ASM_LABEL    , LBL_ADJUST ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EXACT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_EXACT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_SAME   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* fmod(a, b) */
+/*
+ * def fmod(a, b)
+ *     if a and b are integers then
+ *         if b == 0 then return nan end
+ *         return a - (a / b) * b
+ *     end
+ *     if b == 0 or a ~= a or b ~= b or abs(a) == inf then return nan end
+ *     if abs(b) == inf then return a end
+ *     r, d = abs(a), abs(b)
+ *     while d * 2 <= r do d = d * 2 end
+ *     while d >= abs(b) do
+ *         if r >= d then r = r - d end
+ *         d = d / 2
+ *     end
+ *     if a < 0 then r = -r end
+ *     return r
+ * end
+ *
+ * Long division on doubles, every subtraction is exact
+ */
+static int mlua_icg_add_built_in_procs_math_fmod( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_FLOAT = 0, LBL_NAN = 1, LBL_SCALE = 2, LBL_REDUCE = 3;
+    const int LBL_SKIP = 4, LBL_DONE = 5, LBL_POSITIVE = 6, LBL_FINITE = 7;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "a",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "b",
+
+                    /* Integers */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FLOAT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "b",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FLOAT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "b",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NAN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "b",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "b",
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    /* Floats */
+                    MULTIPLY_ASM_LABEL    , LBL_FLOAT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "b",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "ab",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "a",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+
+                    /* Zero divisor, infinite dividend and nan */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ab",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NAN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_INF   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NAN,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ab",
+                    MULTIPLY_ASM_OP_INF   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FINITE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_FINITE ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ab",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "d",
+                    MULTIPLY_ASM_LABEL    , LBL_SCALE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_REDUCE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "d",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SCALE,
+
+                    MULTIPLY_ASM_LABEL    , LBL_REDUCE ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "ab",
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SKIP,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_SKIP   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "d",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "d",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_REDUCE,
+
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "a",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_LABEL    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_NAN    ,
+                    MULTIPLY_ASM_OP_NAN   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+static int mlua_icg_add_built_in_procs_math_huge( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_INF  , OP_PUSH , 0,
+                    MULTIPLY_ASM_OP     , OP_RETURN  , 
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* log(x [, base]) */
+/*
+ * def log(x, base)
+ *     for each of x and base (when given) do
+ *         if x ~= x or x < 0 then r = nan
+ *         elseif x == 0 then r = -inf
+ *         elseif x == inf then r = inf
+ *         else
+ *             x = m * 2^e, sqrt(2) / 2 <= m <= sqrt(2)
+ *             s = (m - 1) / (m + 1)
+ *             r = 2 * (s + s^3 / 3 + s^5 / 5 + ...) + e * ln(2)
+ *         end
+ *     end
+ *     return base and log(x) / log(base) or log(x)
+ * end
+ *
+ * |s| <= 0.1716 after the reduction, 14 terms of the series
+ * are below 1e-17
+ */
+static int mlua_icg_add_built_in_procs_math_log( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_ARGS = 0, LBL_START = 1, LBL_NOT_NAN = 2, LBL_NOT_ZERO = 3, LBL_FINITE = 4;
+    const int LBL_SHRINK = 5, LBL_GROW = 6, LBL_HALVE = 7, LBL_DOUBLE = 8, LBL_SERIES = 9;
+    const int LBL_TERM = 10, LBL_SERIES_DONE = 11, LBL_RESULT = 12, LBL_BASE = 13;
+    const int LBL_NAN = 14, LBL_ZERO = 15, LBL_INF = 16, LBL_DIVIDE = 17;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "base",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ARGS,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "base",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+                    MULTIPLY_ASM_OP_FALSE , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "phase",
+
+                    /* As a float */
+                    MULTIPLY_ASM_LABEL    , LBL_START  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+
+                    /* Domain */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_NAN,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_NAN,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_NAN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_ZERO,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ZERO,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_ZERO,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_INF   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FINITE,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_INF,
+                    MULTIPLY_ASM_LABEL    , LBL_FINITE ,
+
+                    /* x = m * 2^e, coarse steps of 2^16 first */
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "e",
+                    MULTIPLY_ASM_LABEL    , LBL_SHRINK ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)65536.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_GROW,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)65536.0,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "e",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)16.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "e",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SHRINK,
+                    MULTIPLY_ASM_LABEL    , LBL_GROW   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.52587890625e-05,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HALVE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)65536.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "e",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)16.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "e",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_GROW,
+                    MULTIPLY_ASM_LABEL    , LBL_HALVE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.4142135623730951,
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DOUBLE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "e",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "e",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HALVE,
+                    MULTIPLY_ASM_LABEL    , LBL_DOUBLE ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.70710678118654752,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SERIES,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "e",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "e",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_DOUBLE,
+
+                    /* r = s + s^3 / 3 + s^5 / 5 + ... */
+                    MULTIPLY_ASM_LABEL    , LBL_SERIES ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "term",
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_LABEL    , LBL_TERM   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)27.0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SERIES_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "term",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_TERM,
+                    MULTIPLY_ASM_LABEL    , LBL_SERIES_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)2.0,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "e",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.69314718055994531,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+
+                    /* log(x), then log(base) when given */
+                    MULTIPLY_ASM_LABEL    , LBL_RESULT ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "phase",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BASE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "base",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BASE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "lx",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "base",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+                    MULTIPLY_ASM_OP_TRUE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "phase",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_START,
+                    MULTIPLY_ASM_LABEL    , LBL_BASE   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "phase",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DIVIDE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_DIVIDE ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "lx",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_NAN    ,
+                    MULTIPLY_ASM_OP_NAN   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_RESULT,
+                    MULTIPLY_ASM_LABEL    , LBL_ZERO   ,
+                    MULTIPLY_ASM_OP_INF   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_RESULT,
+                    MULTIPLY_ASM_LABEL    , LBL_INF    ,
+                    MULTIPLY_ASM_OP_INF   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_RESULT,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* max(x, ...) */
+/*
+ * def max(x, ...)
+ *     r = x
+ *     for each v in ... do
+ *         if v > r then r = v end
+ *     end
+ *     return r
+ * end
+ *
+ * Compared after promotion, the winner keeps its own type
+ */
+static int mlua_icg_add_built_in_procs_math_max( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HEAD = 0, LBL_TAIL = 1, LBL_NEXT = 2, LBL_EMPTY = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NEXT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_NEXT   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #1 to 'max' (number expected, got no value)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* min(x, ...) */
+/*
+ * def min(x, ...)
+ *     r = x
+ *     for each v in ... do
+ *         if v < r then r = v end
+ *     end
+ *     return r
+ * end
+ *
+ * Compared after promotion, the winner keeps its own type
+ */
+static int mlua_icg_add_built_in_procs_math_min( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HEAD = 0, LBL_TAIL = 1, LBL_NEXT = 2, LBL_EMPTY = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NEXT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_NEXT   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #1 to 'min' (number expected, got no value)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* modf(x) */
+/*
+ * def modf(x)
+ *     if x is an integer then return x, 0.0 end
+ *     if x ~= x then return x, x end
+ *     t = abs(x)
+ *     if t < 2^52 then
+ *         i = (t + 2^52) - 2^52
+ *         if i > t then i = i - 1 end
+ *     else
+ *         i = t
+ *     end
+ *     if x < 0 then i = -i end
+ *     if i == x then return i, 0.0 end
+ *     return i, x - i
+ * end
+ */
+static int mlua_icg_add_built_in_procs_math_modf( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_INTEGER = 0, LBL_NAN = 1, LBL_SIGN = 2;
+    const int LBL_FRACTION = 3, LBL_EXACT = 4;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_INTEGER,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NAN,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_RAW   , OP_FASTLIB , OP_FASTLIB_ABS,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SIGN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4503599627370496.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SIGN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+
+                    MULTIPLY_ASM_LABEL    , LBL_SIGN   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FRACTION,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP       , OP_NEG     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+
+                    /* Infinities are integral too */
+                    MULTIPLY_ASM_LABEL    , LBL_FRACTION,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EXACT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_EXACT  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_INTEGER,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_NAN    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 2,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
 static int mlua_icg_add_built_in_procs_math_pi( \
         struct multiple_error *err, \
         struct multiple_ir *icode, \
@@ -116,6 +1151,287 @@ done:
     return ret;
 }
 
+/* random([m [, n]]) */
+/*
+ * L'Ecuyer's combined multiplicative generator, every product
+ * is kept below 2^31 with Schrage's decomposition
+ *
+ * def random(m, n)
+ *     s1 = 40014 * (s1 % 53668) - 12211 * (s1 / 53668)
+ *     if s1 < 0 then s1 = s1 + 2147483563 end
+ *     s2 = 40692 * (s2 % 52774) - 3791 * (s2 / 52774)
+ *     if s2 < 0 then s2 = s2 + 2147483399 end
+ *     z = s1 - s2
+ *     if z < 1 then z = z + 2147483562 end
+ *     u = z / 2147483563
+ *     if m == nil then return u end
+ *     if n == nil then low, up = 1, m else low, up = m, n end
+ *     return low + int(u * (up - low + 1))
+ * end
+ */
+static int mlua_icg_add_built_in_procs_math_random( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_SEEDED = 0, LBL_STEP = 1, LBL_S1 = 2, LBL_S2 = 3, LBL_Z = 4;
+    const int LBL_RANGE = 5, LBL_BOUNDS = 6, LBL_NOT_EMPTY = 7, LBL_IN_RANGE = 8, LBL_EMPTY = 9;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    /* State, seeded on first use */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_S1,
+                    MULTIPLY_ASM_OP       , OP_TRYSLV  ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SEEDED,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_SEED1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_SEED2,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_STEP,
+                    MULTIPLY_ASM_LABEL    , LBL_SEEDED ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_S1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_S2,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+
+                    /* s1 = 40014 * (s1 % 53668) - 12211 * (s1 / 53668) */
+                    MULTIPLY_ASM_LABEL    , LBL_STEP   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 53668,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 53668,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 40014,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 12211,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_S1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483563,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_LABEL    , LBL_S1     ,
+
+                    /* s2 = 40692 * (s2 % 52774) - 3791 * (s2 / 52774) */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 52774,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "k",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 52774,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 40692,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 3791,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_S2,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483399,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_LABEL    , LBL_S2     ,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_MATH_RANDOM_S1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_MATH_RANDOM_S2,
+
+                    /* u in (0, 1) */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "z",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "z",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_Z,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "z",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483562,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "z",
+                    MULTIPLY_ASM_LABEL    , LBL_Z      ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "z",
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)0.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)4.6566130573917691e-10,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "u",
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_RANGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "u",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    /* [1, m] or [m, n] */
+                    MULTIPLY_ASM_LABEL    , LBL_RANGE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "up",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "low",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BOUNDS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "low",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "up",
+                    MULTIPLY_ASM_LABEL    , LBL_BOUNDS ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "low",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "low",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "up",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "low",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NOT_EMPTY,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_EMPTY,
+                    MULTIPLY_ASM_LABEL    , LBL_NOT_EMPTY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "u",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "low",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_FLOAT , OP_PUSH    , (double)1.0,
+                    MULTIPLY_ASM_OP       , OP_TYPEUP  ,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "low",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    /* Rounding of the product never passes the bound */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_IN_RANGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "up",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "r",
+                    MULTIPLY_ASM_LABEL    , LBL_IN_RANGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "r",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument to 'random' (interval is empty)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* randomseed([x]) */
+/*
+ * def randomseed(x)
+ *     if x == nil then
+ *         s1, s2 = SEED1, SEED2
+ *     else
+ *         x = int(x)
+ *         s1 = 1 + x % 2147483562, taken positive
+ *         s2 = 2147483398 - x % 2147483398, taken positive
+ *     end
+ * end
+ *
+ * The seeds start from either end of their ranges, small seeds
+ * would otherwise give close first results
+ */
+static int mlua_icg_add_built_in_procs_math_randomseed( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_SEED = 0, LBL_STORE = 1, LBL_S1 = 2, LBL_S2 = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SEED,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_SEED1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , MLUA_ICG_STDLIB_MATH_RANDOM_SEED2,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_STORE,
+
+                    MULTIPLY_ASM_LABEL    , LBL_SEED   ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "x",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "x",
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483562,
+                    MULTIPLY_ASM_OP       , OP_MOD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_S1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483562,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+                    MULTIPLY_ASM_LABEL    , LBL_S1     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s1",
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "x",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483398,
+                    MULTIPLY_ASM_OP       , OP_MOD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_S2,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483398,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+                    MULTIPLY_ASM_LABEL    , LBL_S2     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2147483398,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s2",
+
+                    MULTIPLY_ASM_LABEL    , LBL_STORE  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s1",
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_MATH_RANDOM_S1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s2",
+                    MULTIPLY_ASM_OP_ID    , OP_POPG    , MLUA_ICG_STDLIB_MATH_RANDOM_S2,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
 static int mlua_icg_add_built_in_procs_math_sin( \
         struct multiple_error *err, \
         struct multiple_ir *icode, \
@@ -176,17 +1492,53 @@ done:
     return ret;
 }
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[];
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[];
 
-struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[] =
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[] =
 {
     { MLUA_BUILT_IN_METHOD, "abs", 3, mlua_icg_add_built_in_procs_math_abs },
+    { MLUA_BUILT_IN_METHOD, "atan", 4, mlua_icg_add_built_in_procs_math_atan2 },
+    { MLUA_BUILT_IN_METHOD, "atan2", 5, mlua_icg_add_built_in_procs_math_atan2 },
+    { MLUA_BUILT_IN_METHOD, "ceil", 4, mlua_icg_add_built_in_procs_math_ceil },
     { MLUA_BUILT_IN_METHOD, "cos", 3, mlua_icg_add_built_in_procs_math_cos },
     { MLUA_BUILT_IN_METHOD, "exp", 3, mlua_icg_add_built_in_procs_math_exp },
+    { MLUA_BUILT_IN_METHOD, "floor", 5, mlua_icg_add_built_in_procs_math_floor },
+    { MLUA_BUILT_IN_METHOD, "fmod", 4, mlua_icg_add_built_in_procs_math_fmod },
+    { MLUA_BUILT_IN_PROPERTY, "huge", 4, mlua_icg_add_built_in_procs_math_huge },
+    { MLUA_BUILT_IN_METHOD, "log", 3, mlua_icg_add_built_in_procs_math_log },
+    { MLUA_BUILT_IN_METHOD, "max", 3, mlua_icg_add_built_in_procs_math_max },
+    { MLUA_BUILT_IN_METHOD, "min", 3, mlua_icg_add_built_in_procs_math_min },
+    { MLUA_BUILT_IN_METHOD, "modf", 4, mlua_icg_add_built_in_procs_math_modf },
     { MLUA_BUILT_IN_PROPERTY, "pi", 2, mlua_icg_add_built_in_procs_math_pi },
+    { MLUA_BUILT_IN_METHOD, "random", 6, mlua_icg_add_built_in_procs_math_random },
+    { MLUA_BUILT_IN_METHOD, "randomseed", 10, mlua_icg_add_built_in_procs_math_randomseed },
     { MLUA_BUILT_IN_METHOD, "sin", 3, mlua_icg_add_built_in_procs_math_sin },
     { MLUA_BUILT_IN_METHOD, "sqrt", 4, mlua_icg_add_built_in_procs_math_sqrt },
     { MLUA_BUILT_IN_METHOD, "tan", 3, mlua_icg_add_built_in_procs_math_tan },
     { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
 };
 
+
+/* Constants */
+
+static int mlua_icg_inline_math_huge(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block)
+{
+    return mlua_icg_inline_push_float(err, context, icg_fcb_block, HUGE_VAL);
+}
+
+static int mlua_icg_inline_math_pi(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block)
+{
+    return mlua_icg_inline_push_float(err, context, icg_fcb_block, 3.14159265358979323846);
+}
+
+const struct mlua_icg_inline_constant mlua_icg_inline_constants_math[] =
+{
+    { "math.huge", 9, mlua_icg_inline_math_huge },
+    { "math.pi", 7, mlua_icg_inline_math_pi },
+    { NULL, 0, NULL },
+};
+
@@ -22,8 +22,17 @@
 #define _MLUA_ICG_STDLIB_MATH_H_
 
 #include "mlua_icg_stdlib_hdl.h"
+#include "mlua_icg_inline.h"
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[];
+/* State of 'math.random', kept in globals between calls */
+#define MLUA_ICG_STDLIB_MATH_RANDOM_S1 "__math_random_s1"
+#define MLUA_ICG_STDLIB_MATH_RANDOM_S2 "__math_random_s2"
+#define MLUA_ICG_STDLIB_MATH_RANDOM_SEED1 12345
+#define MLUA_ICG_STDLIB_MATH_RANDOM_SEED2 67890
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_math[];
+
+extern const struct mlua_icg_inline_constant mlua_icg_inline_constants_math[];
 
 #endif
 
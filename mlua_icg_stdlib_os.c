@@ -36,7 +36,18 @@
 #include "mlua_ast.h"
 #include "mlua_icg.h"
 #include "mlua_icg_fcb.h"
+#include "mlua_icg_stdlib_io.h"
 
+/* The virtual machine reads no clock and passes no environment to
+ * programs, so 'clock', 'time', 'date' and 'getenv' are not provided */
+
+/* exit() */
+/*
+ * def exit()
+ *     flush()
+ *     halt
+ * end
+ */
 static int mlua_icg_add_built_in_procs_os_exit( \
         struct multiple_error *err, \
         struct multiple_ir *icode, \
@@ -45,7 +56,8 @@ static int mlua_icg_add_built_in_procs_os_exit( \
     int ret = 0;
 
     if ((ret = multiply_asm(err, icode, res_id, 
-                    MULTIPLY_ASM_OP     , OP_HALT, 
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP       , OP_HALT    , 
 
                     MULTIPLY_ASM_FINISH)) != 0)
     { goto fail; } 
@@ -55,11 +67,11 @@ done:
     return ret;
 }
 
-extern struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_os[];
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_os[];
 
-struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_os[] =
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_os[] =
 {
-    { MLUA_BUILT_IN_METHOD, "exit", 6, mlua_icg_add_built_in_procs_os_exit },
+    { MLUA_BUILT_IN_METHOD, "exit", 4, mlua_icg_add_built_in_procs_os_exit },
     { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
 };
 
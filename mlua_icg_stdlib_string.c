@@ -0,0 +1,300 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : String
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_err.h"
+#include "multiple_ir.h"
+
+#include "multiply.h"
+#include "multiply_assembler.h"
+
+#include "vm_opcode.h"
+#include "vm_types.h"
+#include "vm_predef.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_icg.h"
+#include "mlua_icg_fcb.h"
+#include "mlua_icg_context.h"
+#include "mlua_icg_inline.h"
+
+#include "mlua_icg_stdlib_string.h"
+
+/* Run-time procedures, for the calls which can not be inlined
+ * and for the functions used as values */
+
+static int mlua_icg_add_built_in_procs_string_len( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP     , OP_ARGCS   ,
+                    MULTIPLY_ASM_OP_TYPE, OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP     , OP_SIZE    ,
+                    MULTIPLY_ASM_OP     , OP_RETURN  , 
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* rep() */
+/*
+ * def rep(s, n, sep)
+ *     if n <= 0 then return "" end
+ *     unit = s .. sep
+ *     n = n - 1
+ *     result = ""
+ *     while n > 0 do
+ *         if n % 2 == 1 then result = result .. unit end
+ *         unit = unit .. unit
+ *         n = n / 2
+ *     end
+ *     return result .. s
+ * end
+ */
+static int mlua_icg_add_built_in_procs_string_rep( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_SEP = 0, LBL_ARGS = 1, LBL_POSITIVE = 2;
+    const int LBL_HEAD = 3, LBL_EVEN = 4, LBL_TAIL = 5;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "s",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "n",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_SEP,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sep",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_SEP,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "sep",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "s",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "sep",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sep",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "int",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+
+                    /* if n <= 0 then return "" end */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_POSITIVE,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+                    MULTIPLY_ASM_LABEL    , LBL_POSITIVE,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "sep",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "unit",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "result",
+
+                    /* while n > 0 do */
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_MOD     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EVEN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "result",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "unit",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "result",
+                    MULTIPLY_ASM_LABEL    , LBL_EVEN   ,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "unit",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "unit",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "unit",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "result",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "s",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_string[];
+
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_string[] =
+{
+    { MLUA_BUILT_IN_METHOD, "len", 3, mlua_icg_add_built_in_procs_string_len },
+    { MLUA_BUILT_IN_METHOD, "rep", 3, mlua_icg_add_built_in_procs_string_rep },
+    { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
+};
+
+
+/* Inlined calls, 
+ * constant arguments are folded, 
+ * other calls are left to the run-time procedures */
+
+static int mlua_icg_inline_string_convert_str(struct multiple_error *err, \
+        struct mlua_icg_fcb_block *icg_fcb_block)
+{
+    uint32_t type_id;
+
+    if (virtual_machine_object_type_name_to_id(&type_id, "str", 3) != 0) 
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_ICODEGEN, "\'str\' isn't a valid type name");
+        return -MULTIPLE_ERR_ICODEGEN; 
+    }
+    return mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_CONVERT, type_id);
+}
+
+static int mlua_icg_inline_string_len(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *args = NULL;
+    char *str;
+    size_t len;
+
+    if ((ret = mlua_icg_inline_args_new(err, &args, ast_args)) != 0) { goto fail; }
+    /* Bad arguments are left to 'len', whose error shows at run time */
+    if (args->size < 1)
+    { ret = MLUA_ICG_INLINE_DECLINED; goto fail; }
+
+    if (mlua_icg_inline_arg_to_str(&args->args[0], &str, &len) == 0)
+    {
+        if ((ret = mlua_icg_inline_push_int(err, context, icg_fcb_block, (int)len)) != 0)
+        { goto fail; }
+    }
+    else if (args->args[0].type == MLUA_ICG_INLINE_ARG_TYPE_UNKNOWN)
+    {
+        if ((ret = mlua_icg_inline_push_arg(err, context, icg_fcb_block, &args->args[0])) != 0)
+        { goto fail; }
+        if ((ret = mlua_icg_inline_string_convert_str(err, icg_fcb_block)) != 0)
+        { goto fail; }
+        if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, OP_SIZE, 0)) != 0)
+        { goto fail; }
+    }
+    else
+    { ret = MLUA_ICG_INLINE_DECLINED; goto fail; }
+
+    if ((ret = mlua_icg_inline_drop_args(err, context, icg_fcb_block, args, 1)) != 0)
+    { goto fail; }
+
+    goto done;
+fail:
+done:
+    if (args != NULL) mlua_icg_inline_args_destroy(args);
+    return ret;
+}
+
+static int mlua_icg_inline_string_rep(struct multiple_error *err, \
+        struct mlua_icg_context *context, \
+        struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_ast_args *ast_args)
+{
+    int ret = 0;
+    struct mlua_icg_inline_args *args = NULL;
+    struct mlua_icg_inline_buffer buffer;
+    char *str, *sep = "";
+    size_t len, sep_len = 0;
+    int n, idx;
+
+    buffer.body = NULL;
+
+    if ((ret = mlua_icg_inline_args_new(err, &args, ast_args)) != 0) { goto fail; }
+
+    /* Large results and those known only at run time are left to 'rep' */
+    if ((args->constant == 0) || \
+            (args->size < 2) || \
+            (mlua_icg_inline_arg_to_str(&args->args[0], &str, &len) != 0) || \
+            (mlua_icg_inline_arg_to_int(&args->args[1], &n) != 0) || \
+            ((args->size >= 3) && \
+             (args->args[2].type != MLUA_ICG_INLINE_ARG_TYPE_NIL) && \
+             (mlua_icg_inline_arg_to_str(&args->args[2], &sep, &sep_len) != 0)) || \
+            ((n > 0) && ((double)n * (double)(len + sep_len) > (double)MLUA_ICG_INLINE_STR_MAX)))
+    { ret = MLUA_ICG_INLINE_DECLINED; goto fail; }
+
+    if ((ret = mlua_icg_inline_buffer_init(&buffer)) != 0)
+    { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    for (idx = 0; idx < n; idx++)
+    {
+        if (((idx != 0) && ((ret = mlua_icg_inline_buffer_append(&buffer, sep, sep_len)) != 0)) || \
+                ((ret = mlua_icg_inline_buffer_append(&buffer, str, len)) != 0))
+        { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    }
+    if ((ret = mlua_icg_inline_push_str(err, context, icg_fcb_block, \
+                    buffer.body, buffer.size)) != 0)
+    { goto fail; }
+
+    goto done;
+fail:
+done:
+    mlua_icg_inline_buffer_uninit(&buffer);
+    if (args != NULL) mlua_icg_inline_args_destroy(args);
+    return ret;
+}
+
+const struct mlua_icg_inline_handler mlua_icg_inline_handlers_string[] =
+{
+    { "string.len", 10, mlua_icg_inline_string_len },
+    { "string.rep", 10, mlua_icg_inline_string_rep },
+    { NULL, 0, NULL },
+};
+
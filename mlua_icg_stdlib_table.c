@@ -0,0 +1,954 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : Table
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_err.h"
+#include "multiple_ir.h"
+
+#include "multiply.h"
+#include "multiply_assembler.h"
+
+#include "vm_opcode.h"
+#include "vm_types.h"
+#include "vm_predef.h"
+
+#include "mlua_lexer.h"
+#include "mlua_ast.h"
+#include "mlua_icg.h"
+#include "mlua_icg_fcb.h"
+#include "mlua_icg_stdlib_io.h"
+
+#include "mlua_icg_stdlib_table.h"
+
+/* The length of a table is a border, found as 'unbound search' does
+ * in the reference implementation, in O(log n) probes whatever the
+ * count of hash keys:
+ *
+ *     n = 0; hi = 1
+ *     while present(t, hi) do n = hi; hi = hi * 2 end
+ *     while hi - n > 1 do
+ *         mid = (n + hi) / 2
+ *         if present(t, mid) then n = mid else hi = mid end
+ *     end
+ *
+ * where present(t, k) is haskey(t, k) and t[k] ~= nil, as 'remove'
+ * leaves nils behind.
+ *
+ * Every procedure below which needs it emits this block between two
+ * of its own, none of their labels are referenced across it */
+static int mlua_icg_stdlib_table_asm_border( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_UP = 0, LBL_SEARCH = 1, LBL_ABSENT = 2, LBL_TAIL = 3;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "border_hi",
+
+                    /* Double 'hi' until it is absent */
+                    MULTIPLY_ASM_LABEL    , LBL_UP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHHASKEY,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SEARCH,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SEARCH,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "border_hi",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_UP,
+
+                    /* Bisect between the last present and the first absent */
+                    MULTIPLY_ASM_LABEL    , LBL_SEARCH ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_hi",
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "border_mid",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_mid",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHHASKEY,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ABSENT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_mid",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ABSENT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_mid",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SEARCH,
+                    MULTIPLY_ASM_LABEL    , LBL_ABSENT ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "border_mid",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "border_hi",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SEARCH,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* insert() */
+/*
+ * def insert(t, pos, v)
+ *     if v is absent then t[n + 1] = pos; return end
+ *     if pos < 1 or pos > n + 1 then error("position out of bounds") end
+ *     i = n
+ *     while i >= pos do
+ *         t[i + 1] = t[i]
+ *         i = i - 1
+ *     end
+ *     t[pos] = v
+ * end
+ */
+static int mlua_icg_add_built_in_procs_table_insert( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_POS = 0, LBL_HEAD = 1, LBL_SET = 2, LBL_HAS_KEY = 3;
+    const int LBL_GOT = 4, LBL_TAIL = 5, LBL_BOUNDS = 6;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "v",
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_stdlib_table_asm_border(err, icode, res_id)) != 0)
+    { goto fail; }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+
+                    /* Append */
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_POS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_TAIL,
+
+                    /* Shift t[pos..n] up by one in a single pass from the end */
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_POS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BOUNDS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_BOUNDS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SET,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHHASKEY,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_GOT,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_LABEL    , LBL_GOT    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+                    MULTIPLY_ASM_LABEL    , LBL_SET    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 0,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_BOUNDS ,
+                    MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "error: bad argument #2 to 'insert' (position out of bounds)\n",
+                    MULTIPLY_ASM_OP       , OP_PRINT   ,
+                    MULTIPLY_ASM_OP       , OP_HALT    ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* remove() */
+/*
+ * def remove(t, pos)
+ *     if pos is absent then pos = n end
+ *     if n == 0 or pos < 1 or pos > n then return nil end
+ *     v = t[pos]
+ *     i = pos
+ *     while i < n do
+ *         t[i] = t[i + 1]
+ *         i = i + 1
+ *     end
+ *     t[n] = nil
+ *     return v
+ * end
+ */
+static int mlua_icg_add_built_in_procs_table_remove( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_POS = 0, LBL_ARGS = 1, LBL_HEAD = 2, LBL_HAS_KEY = 3;
+    const int LBL_GOT = 4, LBL_TAIL = 5, LBL_EMPTY = 6;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "t",
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_stdlib_table_asm_border(err, icode, res_id)) != 0)
+    { goto fail; }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_POS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "pos",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_POS,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "pos",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    /* Out of the array part */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "v",
+
+                    /* Shift t[pos + 1..n] down by one in a single pass */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "pos",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHHASKEY,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_GOT,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_LABEL    , LBL_GOT    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "v",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* concat() */
+/*
+ * def concat(t, sep, i, j)
+ *     if i > j then return "" end
+ *     parts = {}
+ *     m = 0
+ *     while i <= j do
+ *         m = m + 1
+ *         parts[m] = tostring(t[i])
+ *         i = i + 1
+ *     end
+ *     while m > 1 do
+ *         w = 0
+ *         k = 1
+ *         while k <= m do
+ *             w = w + 1
+ *             if k == m then parts[w] = parts[k]
+ *             else parts[w] = parts[k] .. sep .. parts[k + 1] end
+ *             k = k + 2
+ *         end
+ *         m = w
+ *     end
+ *     return parts[1]
+ * end
+ *
+ * Adjacent pieces are joined pairwise, every round halves the count,
+ * each character is copied O(log(j - i)) times instead of O(j - i)
+ */
+static int mlua_icg_add_built_in_procs_table_concat( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_SEP = 0, LBL_SEP = 1, LBL_HAS_I = 2, LBL_I = 3;
+    const int LBL_HAS_J = 4, LBL_ARGS = 5, LBL_COPY = 6, LBL_MERGE = 7;
+    const int LBL_PAIR = 8, LBL_ODD = 9, LBL_STORE = 10, LBL_ROUND = 11;
+    const int LBL_DONE = 12, LBL_EMPTY = 13, LBL_J = 14;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "t",
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_SEP,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sep",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SEP,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_SEP,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "sep",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "sep",
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sep",
+                    MULTIPLY_ASM_LABEL    , LBL_SEP    ,
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_I,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_I,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_I  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_I      ,
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_J,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "j",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_J,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_J  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "j",
+                    MULTIPLY_ASM_LABEL    , LBL_J      ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_stdlib_table_asm_border(err, icode, res_id)) != 0)
+    { goto fail; }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    /* 'j' defaults to the length */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "j",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ARGS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "j",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "j",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_EMPTY,
+
+                    /* Pieces as strings */
+                    MULTIPLY_ASM_OP_RAW   , OP_HASHMK  , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "parts",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "m",
+                    MULTIPLY_ASM_LABEL    , LBL_COPY   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "j",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_MERGE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_TYPE  , OP_CONVERT , "str",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "m",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "m",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_COPY,
+
+                    /* Join pairwise until one piece is left */
+                    MLUA_ICG_STDLIB_TABLE_ASM_JOIN(LBL_MERGE, LBL_PAIR, LBL_ODD, \
+                            LBL_STORE, LBL_ROUND, LBL_DONE),
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_EMPTY  ,
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* sort() */
+/*
+ * def sort(t, comp)
+ *     start = n / 2
+ *     while start >= 1 do sift(start, n); start = start - 1 end
+ *     last = n
+ *     while last > 1 do
+ *         t[1], t[last] = t[last], t[1]
+ *         sift(1, last - 1)
+ *         last = last - 1
+ *     end
+ * end
+ *
+ * def sift(root, last)
+ *     while root * 2 <= last do
+ *         child = root * 2
+ *         if child < last and less(t[child], t[child + 1]) then child = child + 1 end
+ *         if not less(t[root], t[child]) then return end
+ *         t[root], t[child] = t[child], t[root]
+ *         root = child
+ *     end
+ * end
+ *
+ * Heapsort, O(n log n) in the worst case and in place. 'sift' is shared
+ * by both phases, 'sorting' tells where it returns to. Without a
+ * comparator 'less' is a single OP_L instead of a call
+ */
+static int mlua_icg_add_built_in_procs_table_sort( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HAS_COMP = 0, LBL_ARGS = 1;
+    const int LBL_HEAPIFY = 2, LBL_HEAPIFY_NEXT = 3;
+    const int LBL_SORTDOWN_INIT = 4, LBL_SORTDOWN = 5, LBL_SORTDOWN_NEXT = 6;
+    const int LBL_SIFT = 7, LBL_CHILD = 8, LBL_SIFT_DONE = 9, LBL_DONE = 10;
+    const int LBL_FAST_1 = 11, LBL_SCALAR_1 = 12, LBL_NO_RESULT_1 = 13, LBL_LESS_1 = 14;
+    const int LBL_FAST_2 = 15, LBL_SCALAR_2 = 16, LBL_NO_RESULT_2 = 17, LBL_LESS_2 = 18;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "t",
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_COMP,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "comp",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_ARGS,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_COMP,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "comp",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_stdlib_table_asm_border(err, icode, res_id)) != 0)
+    { goto fail; }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+
+                    /* Build the heap */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_DIV     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "start",
+                    MULTIPLY_ASM_OP_FALSE , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sorting",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAPIFY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "start",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SORTDOWN_INIT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "start",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "root",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "last",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SIFT,
+                    MULTIPLY_ASM_LABEL    , LBL_HEAPIFY_NEXT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "start",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "start",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAPIFY,
+
+                    /* Move the largest to the end, one at a time */
+                    MULTIPLY_ASM_LABEL    , LBL_SORTDOWN_INIT,
+                    MULTIPLY_ASM_OP_TRUE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "sorting",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "end",
+                    MULTIPLY_ASM_LABEL    , LBL_SORTDOWN,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "end",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_LE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_DONE,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "end",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "end",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "root",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "end",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "last",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SIFT,
+                    MULTIPLY_ASM_LABEL    , LBL_SORTDOWN_NEXT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "end",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_SUB     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "end",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SORTDOWN,
+
+                    /* sift(root, last) */
+                    MULTIPLY_ASM_LABEL    , LBL_SIFT   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "root",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_MUL     ,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "last",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SIFT_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "last",
+                    MULTIPLY_ASM_OP       , OP_GE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_CHILD,
+                    /* The larger child */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "comp",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FAST_1,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_REVERSEP,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "comp",
+                    MULTIPLY_ASM_OP       , OP_FUNCMK  ,
+                    MULTIPLY_ASM_OP       , OP_CALLC   ,
+                    /* The first of the results */
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SCALAR_1,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NO_RESULT_1,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_PICK    ,
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SCALAR_1,
+                    MULTIPLY_ASM_LABEL    , LBL_NO_RESULT_1,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP_FALSE , OP_PUSH    ,
+                    MULTIPLY_ASM_LABEL    , LBL_SCALAR_1,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_LESS_1,
+                    /* No comparator, numbers and strings compare directly */
+                    MULTIPLY_ASM_LABEL    , LBL_FAST_1,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_LABEL    , LBL_LESS_1,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_CHILD,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "child",
+                    MULTIPLY_ASM_LABEL    , LBL_CHILD  ,
+                    /* Stop when the root is not less than the child */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "root",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "comp",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_FAST_2,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_REVERSEP,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "comp",
+                    MULTIPLY_ASM_OP       , OP_FUNCMK  ,
+                    MULTIPLY_ASM_OP       , OP_CALLC   ,
+                    /* The first of the results */
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 0,
+                    MULTIPLY_ASM_OP       , OP_TYPE    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SCALAR_2,
+                    MULTIPLY_ASM_OP       , OP_DUP     ,
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_NO_RESULT_2,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2,
+                    MULTIPLY_ASM_OP       , OP_PICK    ,
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SCALAR_2,
+                    MULTIPLY_ASM_LABEL    , LBL_NO_RESULT_2,
+                    MULTIPLY_ASM_OP       , OP_DROP    ,
+                    MULTIPLY_ASM_OP_FALSE , OP_PUSH    ,
+                    MULTIPLY_ASM_LABEL    , LBL_SCALAR_2,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_LESS_2,
+                    /* No comparator, numbers and strings compare directly */
+                    MULTIPLY_ASM_LABEL    , LBL_FAST_2,
+                    MULTIPLY_ASM_OP       , OP_L       ,
+                    MULTIPLY_ASM_LABEL    , LBL_LESS_2,
+                    MULTIPLY_ASM_OP       , OP_NOTL    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SIFT_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "root",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "root",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "child",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "root",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_SIFT,
+                    MULTIPLY_ASM_LABEL    , LBL_SIFT_DONE,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "sorting",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_SORTDOWN_NEXT,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAPIFY_NEXT,
+
+                    MULTIPLY_ASM_LABEL    , LBL_DONE   ,
+                    MULTIPLY_ASM_OP_RAW   , OP_LSTMK   , 0,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* pack(...) */
+/*
+ * def pack(...)
+ *     t = {}
+ *     for i = 0, size(args) - 1 do t[i + 1] = args[i] end
+ *     t.n = size(args)
+ *     return t
+ * end
+ */
+static int mlua_icg_add_built_in_procs_table_pack( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_HEAD = 0, LBL_TAIL = 1;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+                    MULTIPLY_ASM_OP_RAW   , OP_HASHMK  , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "t",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_SIZE    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "n",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP       , OP_EQ      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_TAIL,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+                    MULTIPLY_ASM_LABEL    , LBL_TAIL   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_STR   , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHADD ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+/* unpack() */
+/*
+ * def unpack(t, i, j)
+ *     push t[i], ..., t[j]
+ *     return collect(t[i], ..., t[j])
+ * end
+ *
+ * def collect(...)
+ *     return args
+ * end
+ *
+ * OP_LSTMK takes the count as an operand, the results are passed as
+ * the arguments of 'collect' instead which OP_LSTARGC turns into a
+ * list of any length. 'collect' sits right behind the jump at the
+ * entry of 'unpack'
+ */
+static int mlua_icg_add_built_in_procs_table_unpack( \
+        struct multiple_error *err, \
+        struct multiple_ir *icode, \
+        struct multiply_resource_id_pool *res_id)
+{
+    int ret = 0;
+    const int LBL_UNPACK = 0, LBL_HAS_I = 1, LBL_I = 2, LBL_HAS_J = 3;
+    const int LBL_J = 4, LBL_ARGS = 5, LBL_HEAD = 6, LBL_HAS_KEY = 7;
+    const int LBL_GOT = 8, LBL_COLLECT = 9;
+    uint32_t instrument_number_collect = (uint32_t)(icode->text_section->size) + 1;
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_UNPACK,
+
+                    /* collect() */
+                    MULTIPLY_ASM_OP_ID    , OP_LSTARGC , "args",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "args",
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_LABEL    , LBL_UNPACK ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "t",
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_I,
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_I,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_I  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "i",
+                    MULTIPLY_ASM_LABEL    , LBL_I      ,
+
+                    MULTIPLY_ASM_OP       , OP_ARGP    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_J,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "j",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_J,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_J  ,
+                    MULTIPLY_ASM_OP_ID    , OP_ARGC    , "j",
+                    MULTIPLY_ASM_LABEL    , LBL_J      ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_icg_stdlib_table_asm_border(err, icode, res_id)) != 0)
+    { goto fail; }
+
+    if ((ret = multiply_asm(err, icode, res_id, 
+                    /* 'j' defaults to the length */
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "j",
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP       , OP_NE      ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_ARGS,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "n",
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "j",
+                    MULTIPLY_ASM_LABEL    , LBL_ARGS   ,
+
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "count",
+
+                    /* Push t[i..j], nothing when j < i */
+                    MULTIPLY_ASM_LABEL    , LBL_HEAD   ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "j",
+                    MULTIPLY_ASM_OP       , OP_G       ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_COLLECT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_HASHHASKEY,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_NONE  , OP_PUSH    ,
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_GOT,
+                    MULTIPLY_ASM_LABEL    , LBL_HAS_KEY,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "t",
+                    MULTIPLY_ASM_OP       , OP_REFGET  ,
+                    MULTIPLY_ASM_LABEL    , LBL_GOT    ,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "count",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "count",
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "i",
+                    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1,
+                    MULTIPLY_ASM_OP       , OP_ADD     ,
+                    MULTIPLY_ASM_OP_ID    , OP_POP     , "i",
+                    MULTIPLY_ASM_OP_LBL   , OP_JMP     , LBL_HEAD,
+
+                    /* Call 'collect' with the pushed */
+                    MULTIPLY_ASM_LABEL    , LBL_COLLECT,
+                    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "count",
+                    MULTIPLY_ASM_OP       , OP_REVERSEP,
+                    MULTIPLY_ASM_OP_RAW   , OP_LAMBDAMK, instrument_number_collect,
+                    MULTIPLY_ASM_OP       , OP_FUNCMK  ,
+                    MULTIPLY_ASM_OP       , OP_CALLC   ,
+                    MULTIPLY_ASM_OP       , OP_RETURN  ,
+
+                    MULTIPLY_ASM_FINISH)) != 0)
+    { goto fail; } 
+    goto done;
+fail:
+done:
+    return ret;
+}
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_table[];
+
+const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_table[] =
+{
+    { MLUA_BUILT_IN_METHOD, "concat", 6, mlua_icg_add_built_in_procs_table_concat },
+    { MLUA_BUILT_IN_METHOD, "insert", 6, mlua_icg_add_built_in_procs_table_insert },
+    { MLUA_BUILT_IN_METHOD, "pack", 4, mlua_icg_add_built_in_procs_table_pack },
+    { MLUA_BUILT_IN_METHOD, "remove", 6, mlua_icg_add_built_in_procs_table_remove },
+    { MLUA_BUILT_IN_METHOD, "sort", 4, mlua_icg_add_built_in_procs_table_sort },
+    { MLUA_BUILT_IN_METHOD, "unpack", 6, mlua_icg_add_built_in_procs_table_unpack },
+    { MLUA_BUILT_IN_FINISH, NULL, 0, NULL},
+};
+
@@ -0,0 +1,89 @@
+/* Multiple Lua Programming Language : Intermediate Code Generator
+ * Standard Library : Table
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
+   */
+
+#ifndef _MLUA_ICG_STDLIB_TABLE_H_
+#define _MLUA_ICG_STDLIB_TABLE_H_
+
+#include "mlua_icg_stdlib_hdl.h"
+
+/* Rows joining the strings parts[1..m] pairwise into parts[1], each
+ * round halves 'm' and every character is copied O(log(m)) times.
+ * Uses the locals 'parts', 'sep', 'm', 'w' and 'k' */
+#define MLUA_ICG_STDLIB_TABLE_ASM_JOIN(lbl_merge, lbl_pair, lbl_odd, \
+        lbl_store, lbl_round, lbl_done) \
+    MULTIPLY_ASM_LABEL    , lbl_merge, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "m", \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_LE      , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl_done, \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 0, \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , "w", \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , "k", \
+    MULTIPLY_ASM_LABEL    , lbl_pair, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "m", \
+    MULTIPLY_ASM_OP       , OP_G       , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl_round, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "w", \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , "w", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "m", \
+    MULTIPLY_ASM_OP       , OP_EQ      , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMPC    , lbl_odd, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts", \
+    MULTIPLY_ASM_OP       , OP_REFGET  , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "sep", \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 1, \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts", \
+    MULTIPLY_ASM_OP       , OP_REFGET  , \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_LBL   , OP_JMP     , lbl_store, \
+    MULTIPLY_ASM_LABEL    , lbl_odd, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts", \
+    MULTIPLY_ASM_OP       , OP_REFGET  , \
+    MULTIPLY_ASM_LABEL    , lbl_store, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "w", \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "parts", \
+    MULTIPLY_ASM_OP       , OP_HASHADD , \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "k", \
+    MULTIPLY_ASM_OP_INT   , OP_PUSH    , 2, \
+    MULTIPLY_ASM_OP       , OP_ADD     , \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , "k", \
+    MULTIPLY_ASM_OP_LBL   , OP_JMP     , lbl_pair, \
+    MULTIPLY_ASM_LABEL    , lbl_round, \
+    MULTIPLY_ASM_OP_ID    , OP_PUSH    , "w", \
+    MULTIPLY_ASM_OP_ID    , OP_POP     , "m", \
+    MULTIPLY_ASM_OP_LBL   , OP_JMP     , lbl_merge, \
+    MULTIPLY_ASM_LABEL    , lbl_done
+
+extern const struct mlua_icg_add_built_in_field_handler mlua_icg_add_built_in_field_handlers_table[];
+
+#endif
+
+
+
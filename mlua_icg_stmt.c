@@ -43,6 +43,7 @@
 
 #include "mlua_icg_fcb.h"
 #include "mlua_icg_context.h"
+#include "mlua_icg_stdlib_io.h"
 #include "mlua_icg_aux.h"
 
 #include "mlua_icg_expr.h"
@@ -59,15 +60,14 @@ int mlua_icodegen_explist(struct multiple_error *err, \
     int ret = 0;
     struct mlua_ast_expression *exp_cur;
     uint32_t id_zero;
-    struct multiply_text_precompiled *new_text_precompiled_1 = NULL;
-    struct multiply_text_precompiled *new_text_precompiled_2 = NULL;
     const int LBL_TAIL = 0, LBL_1 = 1;
 
     /* the last (or the only) */
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_EXPLIST_LAST] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled_1, \
+                    &context->templates[MLUA_ICG_TEMPLATE_EXPLIST_LAST], \
 
                     /* Preserve the value */
                     MULTIPLY_ASM_OP     , OP_DUP       ,
@@ -114,15 +114,16 @@ int mlua_icodegen_explist(struct multiple_error *err, \
                     /* lbl_tail: */
                     MULTIPLY_ASM_LABEL  , LBL_TAIL     ,     
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
                     { goto fail; }
 
     /* Not the last one */
     /* If the value is a list, get the first element */
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_EXPLIST_NOT_LAST] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled_2, \
+                    &context->templates[MLUA_ICG_TEMPLATE_EXPLIST_NOT_LAST], \
 
                     /* Preserve the value */
                     MULTIPLY_ASM_OP     , OP_DUP       ,
@@ -172,7 +173,7 @@ int mlua_icodegen_explist(struct multiple_error *err, \
 
                     /* State : <bottom> ... new_exp, count + 1 <top> */
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
                     { goto fail; }
 
     /* zero */
@@ -203,7 +204,7 @@ int mlua_icodegen_explist(struct multiple_error *err, \
         {
             if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                             icg_fcb_block, \
-                            new_text_precompiled_1)) != 0)
+                            context->templates[MLUA_ICG_TEMPLATE_EXPLIST_LAST])) != 0)
             { goto fail; }
         }
         else
@@ -211,7 +212,7 @@ int mlua_icodegen_explist(struct multiple_error *err, \
 
             if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                             icg_fcb_block, \
-                            new_text_precompiled_2)) != 0)
+                            context->templates[MLUA_ICG_TEMPLATE_EXPLIST_NOT_LAST])) != 0)
             { goto fail; }
         }
 
@@ -221,10 +222,6 @@ int mlua_icodegen_explist(struct multiple_error *err, \
     goto done;
 fail:
 done:
-    if (new_text_precompiled_1 != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled_1); }
-    if (new_text_precompiled_2 != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled_2); }
     return ret;
 }
 
@@ -237,16 +234,18 @@ int mlua_icodegen_trim_explist(struct multiple_error *err, \
         size_t maximum)
 {
     int ret = 0;
-    struct multiply_text_precompiled *new_text_precompiled_drop_extra_exp = NULL;
+    uint32_t id;
+    uint32_t instrument_number;
     const int LBL_TAIL = 0, LBL_REPEAT = 1;
 
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_TRIM_EXPLIST] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled_drop_extra_exp, \
+                    &context->templates[MLUA_ICG_TEMPLATE_TRIM_EXPLIST], \
 
                     /* Preserve the result count */
-                    MULTIPLY_ASM_OP_INT   , OP_PUSH       , (int)maximum,
+                    MULTIPLY_ASM_OP_RAW   , OP_PUSH       , 0,
 
                     /* State : <bottom> elements, count_of_elements, count_of_vars <top> */
                     MULTIPLY_ASM_LABEL    , LBL_REPEAT    ,
@@ -280,19 +279,26 @@ int mlua_icodegen_trim_explist(struct multiple_error *err, \
                     /* Drop count of vars */
                     MULTIPLY_ASM_OP       , OP_DROP       ,
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
+    { goto fail; }
+
+    if ((ret = multiply_resource_get_int(err, context->icode, context->res_id, \
+                    &id, (int)maximum)) != 0)
     { goto fail; }
 
+    instrument_number = mlua_icg_fcb_block_get_instrument_number(icg_fcb_block);
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled_drop_extra_exp)) != 0)
+                    context->templates[MLUA_ICG_TEMPLATE_TRIM_EXPLIST])) != 0)
+    { goto fail; }
+    /* Result count */
+    if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                    instrument_number, id)) != 0)
     { goto fail; }
 
     goto done;
 fail:
 done:
-    if (new_text_precompiled_drop_extra_exp != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled_drop_extra_exp); }
     return ret;
 }
 
@@ -305,13 +311,15 @@ int mlua_icodegen_parlist(struct multiple_error *err, \
 {
     int ret = 0;
     struct mlua_ast_par *par_cur;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    uint32_t id;
+    uint32_t instrument_number;
     const int LBL_HAS_ARG = 0, LBL_TAIL = 1, LBL_HEAD = 2;
 
-    if ((ret = multiply_asm_precompile(err, \
+    if ((context->templates[MLUA_ICG_TEMPLATE_PARLIST_ARG] == NULL) && \
+            ((ret = multiply_asm_precompile(err, \
                     context->icode, \
                     context->res_id, \
-                    &new_text_precompiled, \
+                    &context->templates[MLUA_ICG_TEMPLATE_PARLIST_ARG], \
 
                     /* arg = {"n"=0} */
                     /* Key */
@@ -324,17 +332,12 @@ int mlua_icodegen_parlist(struct multiple_error *err, \
                     MULTIPLY_ASM_OP_ID  , OP_POPCL   , "arg",
 
 
-                    MULTIPLY_ASM_FINISH)) != 0)
+                    MULTIPLY_ASM_FINISH)) != 0))
     { goto fail; }
     if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                     icg_fcb_block, \
-                    new_text_precompiled)) != 0)
+                    context->templates[MLUA_ICG_TEMPLATE_PARLIST_ARG])) != 0)
     { goto fail; }
-    if (new_text_precompiled != NULL)
-    {
-        multiply_text_precompiled_destroy(new_text_precompiled);
-        new_text_precompiled = NULL; 
-    }
 
     /* Parameter */
     par_cur = parlist->begin;
@@ -346,10 +349,11 @@ int mlua_icodegen_parlist(struct multiple_error *err, \
                 /* Rest */
                 /* Push rest arguments into a table called 'arg' \
                  * with a counter named 'n' */
-                if ((ret = multiply_asm_precompile(err, \
+                if ((context->templates[MLUA_ICG_TEMPLATE_PARLIST_REST] == NULL) && \
+                        ((ret = multiply_asm_precompile(err, \
                                 context->icode, \
                                 context->res_id, \
-                                &new_text_precompiled, \
+                                &context->templates[MLUA_ICG_TEMPLATE_PARLIST_REST], \
 
                                 /* lbl_head: */
                                 MULTIPLY_ASM_LABEL  , LBL_HEAD   ,
@@ -391,44 +395,61 @@ int mlua_icodegen_parlist(struct multiple_error *err, \
                                 /* lbl_tail */
                                 MULTIPLY_ASM_LABEL  , LBL_TAIL   ,
 
-                                MULTIPLY_ASM_FINISH)) != 0)
+                                MULTIPLY_ASM_FINISH)) != 0))
+                { goto fail; }
+
+                if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
+                                icg_fcb_block, \
+                                context->templates[MLUA_ICG_TEMPLATE_PARLIST_REST])) != 0)
                 { goto fail; }
 
                 break;
 
             default:
                 /* Normal */
-                if ((ret = multiply_asm_precompile(err, \
+                if ((context->templates[MLUA_ICG_TEMPLATE_PARLIST_NORMAL] == NULL) && \
+                        ((ret = multiply_asm_precompile(err, \
                                 context->icode, \
                                 context->res_id, \
-                                &new_text_precompiled, \
+                                &context->templates[MLUA_ICG_TEMPLATE_PARLIST_NORMAL], \
 
                                 MULTIPLY_ASM_OP     , OP_ARGP    , 
                                 MULTIPLY_ASM_OP_LBLR, OP_JMPCR   ,   LBL_HAS_ARG,
 
                                 MULTIPLY_ASM_OP_NONE, OP_PUSH    , 
-                                MULTIPLY_ASM_OP_ID  , OP_POPC    ,   par_cur->name->str,
+                                MULTIPLY_ASM_OP_RAW , OP_POPC    ,   0,
                                 MULTIPLY_ASM_OP_LBLR, OP_JMPR    ,   LBL_TAIL,
 
                                 MULTIPLY_ASM_LABEL  , LBL_HAS_ARG,
-                                MULTIPLY_ASM_OP_ID  , OP_ARGC    ,   par_cur->name->str,
+                                MULTIPLY_ASM_OP_RAW , OP_ARGC    ,   0,
 
                                 MULTIPLY_ASM_LABEL  , LBL_TAIL   ,
 
-                                MULTIPLY_ASM_FINISH)) != 0)
+                                MULTIPLY_ASM_FINISH)) != 0))
                 { goto fail; }
-                break;
-        }
 
-        if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
-                        icg_fcb_block, \
-                        new_text_precompiled)) != 0)
-        { goto fail; }
+                if ((ret = multiply_resource_get_id( \
+                                err, \
+                                context->icode, \
+                                context->res_id, \
+                                &id, \
+                                par_cur->name->str, \
+                                par_cur->name->len)) != 0)
+                { goto fail; }
 
-        if (new_text_precompiled != NULL)
-        {
-            multiply_text_precompiled_destroy(new_text_precompiled);
-            new_text_precompiled = NULL; 
+                instrument_number = mlua_icg_fcb_block_get_instrument_number(icg_fcb_block);
+                if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
+                                icg_fcb_block, \
+                                context->templates[MLUA_ICG_TEMPLATE_PARLIST_NORMAL])) != 0)
+                { goto fail; }
+                /* Name of the parameter at both pops */
+                if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                                instrument_number + 3, id)) != 0)
+                { goto fail; }
+                if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                                instrument_number + 5, id)) != 0)
+                { goto fail; }
+                break;
         }
 
         par_cur = par_cur->next; 
@@ -437,8 +458,6 @@ int mlua_icodegen_parlist(struct multiple_error *err, \
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -452,8 +471,9 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
     int ret = 0;
     struct mlua_ast_expression *exp_cur;
     uint32_t id;
+    uint32_t id_idx;
     size_t idx;
-    struct multiply_text_precompiled *new_text_precompiled = NULL;
+    uint32_t instrument_number;
     const int LBL_TAIL = 0, LBL_1 = 1;
 
     /* Right values */
@@ -496,16 +516,17 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
                                         exp_cur->u.primary->u.name->len)) != 0)
                         { goto fail; }
 
-                        if ((ret = multiply_asm_precompile(err, \
+                        if ((context->templates[MLUA_ICG_TEMPLATE_ASSIGN_NAME] == NULL) && \
+                                ((ret = multiply_asm_precompile(err, \
                                         context->icode, \
                                         context->res_id, \
-                                        &new_text_precompiled, \
+                                        &context->templates[MLUA_ICG_TEMPLATE_ASSIGN_NAME], \
 
                                         /* State : <bottom> elements, count <top> */
                                         /* Preserve the value */
                                         MULTIPLY_ASM_OP     , OP_DUP        ,
                                         /* Push var count */ 
-                                        MULTIPLY_ASM_OP_INT , OP_PUSH       , idx,
+                                        MULTIPLY_ASM_OP_RAW , OP_PUSH       , 0,
 
                                         /* State : <bottom> elements, count, count, var_count <top> */
                                         MULTIPLY_ASM_OP     , OP_GE         ,
@@ -513,7 +534,7 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
 
                                         /* Should push nil */
                                         MULTIPLY_ASM_OP_NONE, OP_PUSH       ,
-                                        MULTIPLY_ASM_OP_RAW , OP_POP        , id, 
+                                        MULTIPLY_ASM_OP_RAW , OP_POP        , 0, 
                                         MULTIPLY_ASM_OP_LBLR, OP_JMPR       , LBL_TAIL,
 
                                         MULTIPLY_ASM_LABEL  , LBL_1         ,
@@ -522,22 +543,34 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
                                         MULTIPLY_ASM_OP_INT , OP_PUSH       , 2,
                                         MULTIPLY_ASM_OP     , OP_PICK       , 
 
-                                        MULTIPLY_ASM_OP_RAW , OP_POP        , id, 
+                                        MULTIPLY_ASM_OP_RAW , OP_POP        , 0, 
 
                                         /* lbl_tail: */
                                         MULTIPLY_ASM_LABEL  , LBL_TAIL      ,
 
 
-                                        MULTIPLY_ASM_FINISH)) != 0)
+                                        MULTIPLY_ASM_FINISH)) != 0))
                                         { goto fail; }
 
+                        if ((ret = multiply_resource_get_int(err, context->icode, context->res_id, \
+                                        &id_idx, (int)idx)) != 0)
+                        { goto fail; }
+
+                        instrument_number = mlua_icg_fcb_block_get_instrument_number(icg_fcb_block);
                         if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                                         icg_fcb_block, \
-                                        new_text_precompiled)) != 0)
+                                        context->templates[MLUA_ICG_TEMPLATE_ASSIGN_NAME])) != 0)
+                        { goto fail; }
+                        /* Var count and the name of the variable at both pops */
+                        if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                                        instrument_number + 1, id_idx)) != 0)
+                        { goto fail; }
+                        if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                                        instrument_number + 5, id)) != 0)
+                        { goto fail; }
+                        if ((ret = mlua_icg_fcb_block_link(icg_fcb_block, \
+                                        instrument_number + 9, id)) != 0)
                         { goto fail; }
-
-                        multiply_text_precompiled_destroy(new_text_precompiled);
-                        new_text_precompiled = NULL;
 
                         break;
 
@@ -552,10 +585,11 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
             case MLUA_AST_EXPRESSION_TYPE_SUFFIXED:
 
                 /* State : <bottom> elements, count <top> */
-                if ((ret = multiply_asm_precompile(err, \
+                if ((context->templates[MLUA_ICG_TEMPLATE_ASSIGN_SUFFIXED] == NULL) && \
+                        ((ret = multiply_asm_precompile(err, \
                                 context->icode, \
                                 context->res_id, \
-                                &new_text_precompiled, \
+                                &context->templates[MLUA_ICG_TEMPLATE_ASSIGN_SUFFIXED], \
 
                                 MULTIPLY_ASM_OP_INT , OP_PUSH       , 1,
                                 MULTIPLY_ASM_OP     , OP_SUB        ,
@@ -563,14 +597,12 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
                                 MULTIPLY_ASM_OP_INT , OP_PUSH       , 2,
                                 MULTIPLY_ASM_OP     , OP_PICK       ,
 
-                                MULTIPLY_ASM_FINISH)) != 0)
+                                MULTIPLY_ASM_FINISH)) != 0))
                 { goto fail; }
                 if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
                                 icg_fcb_block, \
-                                new_text_precompiled)) != 0)
+                                context->templates[MLUA_ICG_TEMPLATE_ASSIGN_SUFFIXED])) != 0)
                 { goto fail; }
-                multiply_text_precompiled_destroy(new_text_precompiled);
-                new_text_precompiled = NULL;
 
                 /* State : <bottom> elements, count - 1, exp <top> */
 
@@ -645,8 +677,6 @@ static int mlua_icodegen_statement_assignment_raw(struct multiple_error *err, \
     goto done;
 fail:
 done:
-    if (new_text_precompiled != NULL)
-    { multiply_text_precompiled_destroy(new_text_precompiled); }
     return ret;
 }
 
@@ -1074,6 +1104,7 @@ done:
 static int mlua_icodegen_statement_label(struct multiple_error *err, \
         struct mlua_icg_context *context, \
         struct mlua_icg_fcb_block *icg_fcb_block, \
+        struct mlua_map_offset_label_list *map_offset_label_list, \
         struct mlua_ast_statement_label *stmt_label)
 {
     int ret = 0;
@@ -1084,12 +1115,12 @@ static int mlua_icodegen_statement_label(struct multiple_error *err, \
 
     offset = (uint32_t)icg_fcb_block->size;
 
-    if ((ret = multiply_offset_item_pack_push_back_label(context->offset_item_pack_stack->top, \
-                    offset, \
-                    stmt_label->name->str, \
-                    stmt_label->name->len, \
-                    icg_fcb_block)) != 0)
-    { goto fail; }
+    if (mlua_map_offset_label_list_define( \
+                map_offset_label_list, \
+                offset, \
+                stmt_label->name->str, \
+                stmt_label->name->len) != 0)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
     goto done;
 fail:
@@ -1371,6 +1402,27 @@ static int mlua_icodegen_statement_return(struct multiple_error *err, \
         if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, \
                         OP_LSTMK, (uint32_t)(stmt_return->explist->size))) != 0)
         { goto fail; }
+
+        /* A return in the main chunk ends the program, 
+         * write out what is left in the buffer of standard output */
+        if (icg_fcb_block == context->icg_fcb_block_autorun)
+        {
+            if ((context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH] == NULL) && \
+                    ((ret = multiply_asm_precompile(err, \
+                            context->icode, \
+                            context->res_id, \
+                            &context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH], \
+
+                            MLUA_ICG_STDLIB_IO_ASM_FLUSH,
+
+                            MULTIPLY_ASM_FINISH)) != 0))
+            { goto fail; }
+            if ((ret = mlua_icg_fcb_block_append_from_precompiled_pic_text( \
+                            icg_fcb_block, \
+                            context->templates[MLUA_ICG_TEMPLATE_IO_FLUSH])) != 0)
+            { goto fail; }
+        }
+
         if ((ret = mlua_icg_fcb_block_append_with_configure(icg_fcb_block, \
                         OP_RETURN, 0)) != 0)
         { goto fail; }
@@ -1462,7 +1514,7 @@ static int mlua_icodegen_statement(struct multiple_error *err, \
         case MLUA_AST_STATEMENT_TYPE_LABEL:
             if ((ret = mlua_icodegen_statement_label(err, context, \
                             icg_fcb_block, \
-                            stmt->u.stmt_label)) != 0)
+                            map_offset_label_list, stmt->u.stmt_label)) != 0)
             { goto fail; }
             break;
 
@@ -0,0 +1,266 @@
+/* Multiple Lua Programming Language : Compiled IR Cache
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "mlua_hash.h"
+#include "mlua_ir_cache.h"
+
+/* <dir>/<32 hex digits of the key><ext> */
+#define MLUA_IR_CACHE_NAME_LEN (1 + 32 + sizeof(MLUA_IR_CACHE_EXT) - 1)
+
+struct mlua_ir_cache *mlua_ir_cache_new(char *dir, struct mlua_ir_cache_codec *codec)
+{
+    struct mlua_ir_cache *new_cache = NULL;
+    size_t dir_len = strlen(dir);
+
+    /* 'encode_data' is the only optional callback */
+    if ((codec->encode == NULL) || (codec->decode == NULL)) { return NULL; }
+
+    new_cache = (struct mlua_ir_cache *)malloc(sizeof(struct mlua_ir_cache));
+    if (new_cache == NULL) { goto fail; }
+    new_cache->dir = NULL;
+    new_cache->dir_len = dir_len;
+    new_cache->codec.encode = codec->encode;
+    new_cache->codec.decode = codec->decode;
+    new_cache->codec.encode_data = codec->encode_data;
+    new_cache->dir = (char *)malloc(sizeof(char) * (dir_len + 1));
+    if (new_cache->dir == NULL) { goto fail; }
+    memcpy(new_cache->dir, dir, dir_len);
+    new_cache->dir[dir_len] = '\0';
+
+    goto done;
+fail:
+    if (new_cache != NULL)
+    {
+        mlua_ir_cache_destroy(new_cache);
+        new_cache = NULL;
+    }
+done:
+    return new_cache;
+}
+
+int mlua_ir_cache_destroy(struct mlua_ir_cache *cache)
+{
+    if (cache->dir != NULL) free(cache->dir);
+    free(cache);
+
+    return 0;
+}
+
+/* Two independent 64-bit hashes over compiler version, flags and
+ * source code, the length is kept beside them, they pick the file 
+ * while the source stored in it decides a hit */
+static void mlua_ir_cache_hash_update(uint64_t hash[2], const char *data, size_t len)
+{
+    size_t idx;
+    uint64_t ch;
+
+    /* FNV-1a */
+    hash[0] = mlua_hash_fnv1a_update(hash[0], data, len);
+    for (idx = 0; idx != len; idx++)
+    {
+        ch = (uint64_t)(unsigned char)data[idx];
+        /* Multiply-xorshift */
+        hash[1] = (hash[1] ^ ch) * 11400714819323198485ULL;
+        hash[1] ^= hash[1] >> 29;
+    }
+}
+
+void mlua_ir_cache_key_compute(struct mlua_ir_cache_key *key, \
+        char *code, size_t len, uint32_t flags)
+{
+    unsigned char flags_bytes[4];
+
+    memset(key, 0, sizeof(struct mlua_ir_cache_key));
+    key->hash[0] = MLUA_HASH_FNV1A_INIT;
+    key->hash[1] = 0x6d6c7561ULL;
+    key->len = (uint64_t)len;
+    key->flags = flags;
+
+    flags_bytes[0] = (unsigned char)(flags & 0xff);
+    flags_bytes[1] = (unsigned char)((flags >> 8) & 0xff);
+    flags_bytes[2] = (unsigned char)((flags >> 16) & 0xff);
+    flags_bytes[3] = (unsigned char)((flags >> 24) & 0xff);
+
+    mlua_ir_cache_hash_update(key->hash, MLUA_IR_CACHE_COMPILER_VERSION, \
+            sizeof(MLUA_IR_CACHE_COMPILER_VERSION));
+    mlua_ir_cache_hash_update(key->hash, (char *)flags_bytes, 4);
+    mlua_ir_cache_hash_update(key->hash, code, len);
+}
+
+static int mlua_ir_cache_pathname(struct mlua_ir_cache *cache, \
+        char **pathname_out, struct mlua_ir_cache_key *key)
+{
+    char *new_pathname = NULL;
+    size_t len = cache->dir_len + MLUA_IR_CACHE_NAME_LEN;
+
+    new_pathname = (char *)malloc(sizeof(char) * (len + 1));
+    if (new_pathname == NULL) { return -MULTIPLE_ERR_MALLOC; }
+    sprintf(new_pathname, "%s/%016llx%016llx%s", \
+            cache->dir, \
+            (unsigned long long)key->hash[0], \
+            (unsigned long long)key->hash[1], \
+            MLUA_IR_CACHE_EXT);
+    *pathname_out = new_pathname;
+
+    return 0;
+}
+
+static void mlua_ir_cache_header_init(struct mlua_ir_cache_header *header, \
+        struct mlua_ir_cache_key *key, size_t payload_len)
+{
+    memset(header, 0, sizeof(struct mlua_ir_cache_header));
+    memcpy(header->magic, MLUA_IR_CACHE_MAGIC, MLUA_IR_CACHE_MAGIC_LEN);
+    strncpy(header->compiler_version, MLUA_IR_CACHE_COMPILER_VERSION, \
+            sizeof(header->compiler_version) - 1);
+    memcpy(&header->key, key, sizeof(struct mlua_ir_cache_key));
+    header->payload_len = (uint64_t)payload_len;
+}
+
+int mlua_ir_cache_load(struct multiple_error *err, \
+        struct mlua_ir_cache *cache, \
+        struct multiple_ir **icode_out, \
+        struct mlua_ir_cache_key *key, \
+        char *code, size_t len)
+{
+    int ret = 0;
+    char *pathname = NULL;
+    FILE *fp = NULL;
+    struct mlua_ir_cache_header header, header_expected;
+    char *source = NULL;
+    char *payload = NULL;
+
+    *icode_out = NULL;
+
+    if ((ret = mlua_ir_cache_pathname(cache, &pathname, key)) != 0)
+    { MULTIPLE_ERROR_MALLOC(); goto fail; }
+
+    /* Missing or foreign entries are misses */
+    if ((fp = fopen(pathname, "rb")) == NULL) { goto done; }
+    if (fread(&header, sizeof(struct mlua_ir_cache_header), 1, fp) < 1) { goto done; }
+    mlua_ir_cache_header_init(&header_expected, key, (size_t)header.payload_len);
+    if (memcmp(&header, &header_expected, sizeof(struct mlua_ir_cache_header)) != 0) { goto done; }
+
+    /* Entries of another source with colliding hashes are misses */
+    if ((source = (char *)malloc(sizeof(char) * (len + 1))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    if ((len != 0) && (fread(source, len, 1, fp) < 1)) { goto done; }
+    if (memcmp(source, code, len) != 0) { goto done; }
+
+    if ((payload = (char *)malloc(sizeof(char) * ((size_t)header.payload_len + 1))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    if ((header.payload_len != 0) && \
+            (fread(payload, (size_t)header.payload_len, 1, fp) < 1))
+    { goto done; }
+
+    /* Entries which no longer decode are misses and are dropped */
+    if (cache->codec.decode(err, icode_out, payload, (size_t)header.payload_len) != 0)
+    {
+        *icode_out = NULL;
+        fclose(fp); fp = NULL;
+        remove(pathname);
+        goto done;
+    }
+
+    goto done;
+fail:
+    *icode_out = NULL;
+done:
+    if (fp != NULL) fclose(fp);
+    if (source != NULL) free(source);
+    if (payload != NULL) free(payload);
+    if (pathname != NULL) free(pathname);
+    return ret;
+}
+
+int mlua_ir_cache_store(struct multiple_error *err, \
+        struct mlua_ir_cache *cache, \
+        struct multiple_ir *icode, \
+        struct mlua_ir_cache_key *key, \
+        char *code, size_t len)
+{
+    int ret = 0;
+    char *pathname = NULL;
+    char *pathname_tmp = NULL;
+    FILE *fp = NULL;
+    struct mlua_ir_cache_header header;
+    char *payload = NULL;
+    size_t payload_len = 0;
+    size_t pathname_len;
+    int fd;
+
+    if ((ret = cache->codec.encode(err, &payload, &payload_len, icode)) != 0)
+    { goto fail; }
+
+    if ((ret = mlua_ir_cache_pathname(cache, &pathname, key)) != 0)
+    { MULTIPLE_ERROR_MALLOC(); goto fail; }
+    pathname_len = strlen(pathname);
+    /* Write aside and rename, readers never see a partial entry */
+    if ((pathname_tmp = (char *)malloc(sizeof(char) * (pathname_len + 8))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    sprintf(pathname_tmp, "%s.XXXXXX", pathname);
+
+    mlua_ir_cache_header_init(&header, key, payload_len);
+    if ((fd = mkstemp(pathname_tmp)) == -1) { goto done; }
+    fchmod(fd, 0644);
+    if ((fp = fdopen(fd, "wb")) == NULL)
+    {
+        close(fd);
+        remove(pathname_tmp);
+        goto done;
+    }
+    if ((fwrite(&header, sizeof(struct mlua_ir_cache_header), 1, fp) < 1) || \
+            ((len != 0) && (fwrite(code, len, 1, fp) < 1)) || \
+            ((payload_len != 0) && (fwrite(payload, payload_len, 1, fp) < 1)))
+    {
+        fclose(fp); fp = NULL;
+        remove(pathname_tmp);
+        goto done;
+    }
+    if (fclose(fp) != 0)
+    {
+        fp = NULL;
+        remove(pathname_tmp);
+        goto done;
+    }
+    fp = NULL;
+    if (rename(pathname_tmp, pathname) != 0) { remove(pathname_tmp); }
+
+    goto done;
+fail:
+done:
+    if (fp != NULL) fclose(fp);
+    if (payload != NULL) free(payload);
+    if (pathname_tmp != NULL) free(pathname_tmp);
+    if (pathname != NULL) free(pathname);
+    return ret;
+}
+
@@ -0,0 +1,109 @@
+/* Multiple Lua Programming Language : Compiled IR Cache
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_IR_CACHE_H_
+#define _MLUA_IR_CACHE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+/* Bump whenever the generated IR changes for the same source */
+#define MLUA_IR_CACHE_COMPILER_VERSION "mlua-2014.1"
+#define MLUA_IR_CACHE_MAGIC "MLUAIRC\2"
+#define MLUA_IR_CACHE_MAGIC_LEN 8
+#define MLUA_IR_CACHE_EXT ".mlc"
+
+/* Flags that affect the generated IR */
+#define MLUA_IR_CACHE_FLAG_OPTIMIZE (1 << 0)
+#define MLUA_IR_CACHE_FLAG_DEBUG_INFO (1 << 1)
+
+/* The layout of the IR belongs to libmultiple,
+ * the host supplies the (de)serializer, 
+ * 'encode' returns a buffer allocated with malloc */
+struct mlua_ir_cache_codec
+{
+    int (*encode)(struct multiple_error *err, \
+            char **data_out, size_t *len_out, \
+            struct multiple_ir *icode);
+    int (*decode)(struct multiple_error *err, \
+            struct multiple_ir **icode_out, \
+            char *data, size_t len);
+    /* Optional, everything except the text and export sections,
+     * used by binary images */
+    int (*encode_data)(struct multiple_error *err, \
+            char **data_out, size_t *len_out, \
+            struct multiple_ir *icode);
+};
+
+struct mlua_ir_cache_key
+{
+    uint64_t hash[2];
+    uint64_t len;
+    uint32_t flags;
+};
+
+/* Header of a cache file, followed by the source code it was
+ * compiled from ('key.len' bytes) and then the encoded IR, 
+ * the hashes only name the file, an entry is used only when 
+ * its source is equal to the one being compiled */
+struct mlua_ir_cache_header
+{
+    char magic[MLUA_IR_CACHE_MAGIC_LEN];
+    char compiler_version[16];
+    struct mlua_ir_cache_key key;
+    uint64_t payload_len;
+};
+
+struct mlua_ir_cache
+{
+    /* Directory of cache files */
+    char *dir;
+    size_t dir_len;
+
+    struct mlua_ir_cache_codec codec;
+};
+
+/* NULL when out of memory or when 'encode' or 'decode' is missing */
+struct mlua_ir_cache *mlua_ir_cache_new(char *dir, struct mlua_ir_cache_codec *codec);
+int mlua_ir_cache_destroy(struct mlua_ir_cache *cache);
+
+void mlua_ir_cache_key_compute(struct mlua_ir_cache_key *key, \
+        char *code, size_t len, uint32_t flags);
+
+/* Leaves '*icode_out' NULL when the cache does not hold a valid entry 
+ * for exactly this source code, an entry which fails to decode is 
+ * removed */
+int mlua_ir_cache_load(struct multiple_error *err, \
+        struct mlua_ir_cache *cache, \
+        struct multiple_ir **icode_out, \
+        struct mlua_ir_cache_key *key, \
+        char *code, size_t len);
+
+/* Best effort, an entry that can not be written is simply not cached */
+int mlua_ir_cache_store(struct multiple_error *err, \
+        struct mlua_ir_cache *cache, \
+        struct multiple_ir *icode, \
+        struct mlua_ir_cache_key *key, \
+        char *code, size_t len);
+
+#endif
+
@@ -0,0 +1,317 @@
+/* Multiple Lua Programming Language : Binary IR Image
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "mlua_ir_cache.h"
+#include "mlua_ir_image.h"
+
+#define MLUA_IR_IMAGE_ROUND_UP(x, align) (((x) + ((align) - 1)) & ~((uint64_t)(align) - 1))
+
+/* Header page, text pages, then exports, arguments and data */
+static void mlua_ir_image_layout(struct mlua_ir_image_header *header, \
+        size_t text_count, size_t export_count, size_t args_count, size_t data_len)
+{
+    memset(header, 0, sizeof(struct mlua_ir_image_header));
+    memcpy(header->magic, MLUA_IR_IMAGE_MAGIC, MLUA_IR_IMAGE_MAGIC_LEN);
+    header->version = MLUA_IR_IMAGE_VERSION;
+    header->byte_order = MLUA_IR_IMAGE_BYTE_ORDER;
+
+    header->text_offset = MLUA_IR_IMAGE_PAGE_SIZE;
+    header->text_count = (uint64_t)text_count;
+    header->export_offset = MLUA_IR_IMAGE_ROUND_UP(header->text_offset + \
+            header->text_count * sizeof(struct mlua_ir_image_text_line), MLUA_IR_IMAGE_PAGE_SIZE);
+    header->export_count = (uint64_t)export_count;
+    header->args_offset = MLUA_IR_IMAGE_ROUND_UP(header->export_offset + \
+            header->export_count * sizeof(struct mlua_ir_image_export), MLUA_IR_IMAGE_ALIGN);
+    header->args_count = (uint64_t)args_count;
+    header->data_offset = MLUA_IR_IMAGE_ROUND_UP(header->args_offset + \
+            header->args_count * 2 * sizeof(uint32_t), MLUA_IR_IMAGE_ALIGN);
+    header->data_len = (uint64_t)data_len;
+    header->image_len = header->data_offset + header->data_len;
+}
+
+int mlua_ir_image_write(struct multiple_error *err, \
+        char *pathname, \
+        struct multiple_ir *icode, \
+        struct mlua_ir_cache_codec *codec)
+{
+    int ret = 0;
+    struct mlua_ir_image_header header;
+    struct multiple_ir_text_section_item *text_section_item_cur;
+    struct multiple_ir_export_section_item *export_section_item_cur;
+    struct mlua_ir_image_text_line *text_line;
+    struct mlua_ir_image_export *export;
+    uint32_t *args;
+    char *image = NULL;
+    char *data = NULL;
+    size_t data_len = 0;
+    size_t args_count = 0, args_index = 0;
+    size_t idx;
+    char *pathname_tmp = NULL;
+    int fd;
+    FILE *fp = NULL;
+
+    if ((codec == NULL) || (codec->encode_data == NULL))
+    {
+        MULTIPLE_ERROR_NULL_PTR();
+        ret = -MULTIPLE_ERR_NULL_PTR;
+        goto fail;
+    }
+    if ((ret = codec->encode_data(err, &data, &data_len, icode)) != 0)
+    { goto fail; }
+
+    export_section_item_cur = icode->export_section->begin;
+    while (export_section_item_cur != NULL)
+    {
+        args_count += export_section_item_cur->args_count;
+        export_section_item_cur = export_section_item_cur->next;
+    }
+
+    mlua_ir_image_layout(&header, \
+            icode->text_section->size, icode->export_section->size, \
+            args_count, data_len);
+
+    if ((image = (char *)calloc((size_t)header.image_len, sizeof(char))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    memcpy(image, &header, sizeof(struct mlua_ir_image_header));
+
+    /* Text */
+    text_line = (struct mlua_ir_image_text_line *)(image + header.text_offset);
+    text_section_item_cur = icode->text_section->begin;
+    while (text_section_item_cur != NULL)
+    {
+        text_line->opcode = text_section_item_cur->opcode;
+        text_line->operand = text_section_item_cur->operand;
+        text_line++;
+        text_section_item_cur = text_section_item_cur->next;
+    }
+
+    /* Export and arguments */
+    export = (struct mlua_ir_image_export *)(image + header.export_offset);
+    args = (uint32_t *)(image + header.args_offset);
+    export_section_item_cur = icode->export_section->begin;
+    while (export_section_item_cur != NULL)
+    {
+        export->name = export_section_item_cur->name;
+        export->instrument_number = export_section_item_cur->instrument_number;
+        export->args_count = export_section_item_cur->args_count;
+        export->args_index = (uint32_t)args_index;
+        export->blank = (uint32_t)export_section_item_cur->blank;
+        for (idx = 0; idx != export_section_item_cur->args_count; idx++)
+        {
+            args[args_index * 2] = export_section_item_cur->args[idx];
+            args[args_index * 2 + 1] = export_section_item_cur->args_types[idx];
+            args_index++;
+        }
+        export++;
+        export_section_item_cur = export_section_item_cur->next;
+    }
+
+    /* Data */
+    if (data_len != 0) memcpy(image + header.data_offset, data, data_len);
+
+    /* Write aside and rename, mapped readers keep the old image, 
+     * the name is unique among processes and threads */
+    if ((pathname_tmp = (char *)malloc(sizeof(char) * (strlen(pathname) + 8))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    sprintf(pathname_tmp, "%s.XXXXXX", pathname);
+    if ((fd = mkstemp(pathname_tmp)) == -1)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: can not open file %s for writing", pathname);
+        free(pathname_tmp); pathname_tmp = NULL;
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    fchmod(fd, 0644);
+    if ((fp = fdopen(fd, "wb")) == NULL)
+    {
+        close(fd);
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: can not open file %s for writing", pathname_tmp);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    if (fwrite(image, (size_t)header.image_len, 1, fp) < 1)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: writing data to %s failed", pathname_tmp);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    if (fclose(fp) != 0)
+    {
+        fp = NULL;
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: writing data to %s failed", pathname_tmp);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    fp = NULL;
+    if (rename(pathname_tmp, pathname) != 0)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: can not rename %s to %s", pathname_tmp, pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+
+    goto done;
+fail:
+    if (fp != NULL) { fclose(fp); fp = NULL; }
+    if (pathname_tmp != NULL) remove(pathname_tmp);
+done:
+    if (pathname_tmp != NULL) free(pathname_tmp);
+    if (image != NULL) free(image);
+    if (data != NULL) free(data);
+    return ret;
+}
+
+static int mlua_ir_image_check(struct mlua_ir_image_header *header, size_t len)
+{
+    if (len < sizeof(struct mlua_ir_image_header)) return -1;
+    if (memcmp(header->magic, MLUA_IR_IMAGE_MAGIC, MLUA_IR_IMAGE_MAGIC_LEN) != 0) return -1;
+    if (header->version != MLUA_IR_IMAGE_VERSION) return -1;
+    if (header->byte_order != MLUA_IR_IMAGE_BYTE_ORDER) return -1;
+    if (header->image_len != (uint64_t)len) return -1;
+
+    /* Sections are in order, aligned, and inside the image */
+    if (header->text_offset != MLUA_IR_IMAGE_PAGE_SIZE) return -1;
+    if ((header->export_offset % MLUA_IR_IMAGE_PAGE_SIZE) != 0) return -1;
+    if ((header->args_offset % MLUA_IR_IMAGE_ALIGN) != 0) return -1;
+    if ((header->data_offset % MLUA_IR_IMAGE_ALIGN) != 0) return -1;
+    if (header->text_count > (header->export_offset - header->text_offset) / \
+            sizeof(struct mlua_ir_image_text_line)) return -1;
+    if (header->export_offset > header->args_offset) return -1;
+    if (header->export_count > (header->args_offset - header->export_offset) / \
+            sizeof(struct mlua_ir_image_export)) return -1;
+    if (header->args_offset > header->data_offset) return -1;
+    if (header->args_count > (header->data_offset - header->args_offset) / \
+            (2 * sizeof(uint32_t))) return -1;
+    if (header->data_offset > header->image_len) return -1;
+    if (header->data_len != header->image_len - header->data_offset) return -1;
+
+    return 0;
+}
+
+int mlua_ir_image_map(struct multiple_error *err, \
+        struct mlua_ir_image **image_out, \
+        char *pathname)
+{
+    int ret = 0;
+    int fd = -1;
+    struct stat st;
+    void *addr = MAP_FAILED;
+    struct mlua_ir_image *new_image = NULL;
+    struct mlua_ir_image_header *header;
+    const struct mlua_ir_image_export *export;
+    size_t idx;
+
+    *image_out = NULL;
+
+    if ((fd = open(pathname, O_RDONLY)) < 0)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: can not open file %s for reading", pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    if ((fstat(fd, &st) != 0) || (!S_ISREG(st.st_mode)) || \
+            ((size_t)st.st_size < sizeof(struct mlua_ir_image_header)))
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: %s is not an IR image", pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+    /* Shared and read-only, processes mapping the same image
+     * share the physical pages */
+    addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: can not map file %s", pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+
+    header = (struct mlua_ir_image_header *)addr;
+    if (mlua_ir_image_check(header, (size_t)st.st_size) != 0)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: %s is not a valid IR image", pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+
+    if ((new_image = (struct mlua_ir_image *)malloc(sizeof(struct mlua_ir_image))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    new_image->addr = addr;
+    new_image->len = (size_t)st.st_size;
+    new_image->header = header;
+    new_image->text = (const struct mlua_ir_image_text_line *)((char *)addr + header->text_offset);
+    new_image->text_count = (size_t)header->text_count;
+    new_image->exports = (const struct mlua_ir_image_export *)((char *)addr + header->export_offset);
+    new_image->export_count = (size_t)header->export_count;
+    new_image->args = (const uint32_t *)((char *)addr + header->args_offset);
+    new_image->args_count = (size_t)header->args_count;
+    new_image->data = (const char *)addr + header->data_offset;
+    new_image->data_len = (size_t)header->data_len;
+
+    /* Exports must point inside the text and the arguments */
+    for (idx = 0; idx != new_image->export_count; idx++)
+    {
+        export = &new_image->exports[idx];
+        if ((export->blank == 0) && (export->instrument_number >= new_image->text_count)) break;
+        if ((uint64_t)export->args_index + export->args_count > new_image->args_count) break;
+    }
+    if (idx != new_image->export_count)
+    {
+        multiple_error_update(err, -MULTIPLE_ERR_STUB, "error: %s is not a valid IR image", pathname);
+        ret = -MULTIPLE_ERR_STUB;
+        goto fail;
+    }
+
+    *image_out = new_image;
+    new_image = NULL;
+    addr = MAP_FAILED;
+
+    goto done;
+fail:
+done:
+    if (new_image != NULL) free(new_image);
+    if (addr != MAP_FAILED) munmap(addr, (size_t)st.st_size);
+    /* The mapping stays valid after the descriptor closed */
+    if (fd >= 0) close(fd);
+    return ret;
+}
+
+int mlua_ir_image_unmap(struct mlua_ir_image *image)
+{
+    munmap(image->addr, image->len);
+    free(image);
+
+    return 0;
+}
+
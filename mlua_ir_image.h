@@ -0,0 +1,115 @@
+/* Multiple Lua Programming Language : Binary IR Image
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_IR_IMAGE_H_
+#define _MLUA_IR_IMAGE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "mlua_ir_cache.h"
+
+/* An image is laid out to be mapped read-only and used in place,
+ * every offset is relative to the start of the image and
+ * the text section starts on a page boundary */
+
+#define MLUA_IR_IMAGE_MAGIC "MLUAIMG\0"
+#define MLUA_IR_IMAGE_MAGIC_LEN 8
+#define MLUA_IR_IMAGE_VERSION 1
+#define MLUA_IR_IMAGE_BYTE_ORDER 0x01020304
+#define MLUA_IR_IMAGE_PAGE_SIZE 4096
+#define MLUA_IR_IMAGE_ALIGN 8
+
+struct mlua_ir_image_header
+{
+    char magic[MLUA_IR_IMAGE_MAGIC_LEN];
+    uint32_t version;
+    uint32_t byte_order;
+
+    /* Whole image */
+    uint64_t image_len;
+
+    /* Text section, in 'struct mlua_ir_image_text_line' */
+    uint64_t text_offset;
+    uint64_t text_count;
+
+    /* Export section, in 'struct mlua_ir_image_export' */
+    uint64_t export_offset;
+    uint64_t export_count;
+
+    /* Arguments of exports, pairs of argument and type */
+    uint64_t args_offset;
+    uint64_t args_count;
+
+    /* Data section and resources, encoded by the host */
+    uint64_t data_offset;
+    uint64_t data_len;
+};
+
+/* Operands are final, lambda and built-in procedure
+ * targets were resolved when merging blocks */
+struct mlua_ir_image_text_line
+{
+    uint32_t opcode;
+    uint32_t operand;
+};
+
+struct mlua_ir_image_export
+{
+    uint32_t name;
+    uint32_t instrument_number;
+    uint32_t args_count;
+    /* Index of the first argument pair */
+    uint32_t args_index;
+    uint32_t blank;
+    uint32_t reserved;
+};
+
+/* A mapped image, all pointers point into the mapping */
+struct mlua_ir_image
+{
+    void *addr;
+    size_t len;
+
+    const struct mlua_ir_image_header *header;
+    const struct mlua_ir_image_text_line *text;
+    size_t text_count;
+    const struct mlua_ir_image_export *exports;
+    size_t export_count;
+    const uint32_t *args;
+    size_t args_count;
+    const char *data;
+    size_t data_len;
+};
+
+int mlua_ir_image_write(struct multiple_error *err, \
+        char *pathname, \
+        struct multiple_ir *icode, \
+        struct mlua_ir_cache_codec *codec);
+
+int mlua_ir_image_map(struct multiple_error *err, \
+        struct mlua_ir_image **image_out, \
+        char *pathname);
+int mlua_ir_image_unmap(struct mlua_ir_image *image);
+
+#endif
+
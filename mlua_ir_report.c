@@ -0,0 +1,313 @@
+/* Multiple Lua Programming Language : IR Report
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+#include "vm_opcode.h"
+
+#include "mlua_ir_report.h"
+
+struct mlua_ir_report_opcode
+{
+    uint32_t opcode;
+    const char *name;
+    /* Allocates, hashes or searches at run time */
+    int expensive;
+};
+
+static const struct mlua_ir_report_opcode mlua_ir_report_opcodes[] =
+{
+    {OP_ADD, "add", 0}, {OP_SUB, "sub", 0}, {OP_MUL, "mul", 0},
+    {OP_DIV, "div", 0}, {OP_MOD, "mod", 0}, {OP_NEG, "neg", 0},
+    {OP_EQ, "eq", 0}, {OP_NE, "ne", 0}, {OP_L, "l", 0},
+    {OP_LE, "le", 0}, {OP_G, "g", 0}, {OP_GE, "ge", 0},
+    {OP_NOTL, "notl", 0}, {OP_NOTA, "nota", 0}, {OP_ANDA, "anda", 0},
+    {OP_ORA, "ora", 0}, {OP_XORA, "xora", 0}, {OP_SHL, "shl", 0},
+    {OP_SHR, "shr", 0},
+    {OP_PUSH, "push", 0}, {OP_POP, "pop", 0}, {OP_POPC, "popc", 0},
+    {OP_POPCL, "popcl", 0}, {OP_POPG, "popg", 0}, {OP_DROP, "drop", 0},
+    {OP_DUP, "dup", 0}, {OP_PICK, "pick", 0}, {OP_PICKCP, "pickcp", 0},
+    {OP_LIFT, "lift", 0}, {OP_REVERSE, "reverse", 0}, {OP_REVERSEP, "reversep", 0},
+    {OP_JMP, "jmp", 0}, {OP_JMPC, "jmpc", 0}, {OP_JMPR, "jmpr", 0},
+    {OP_JMPCR, "jmpcr", 0},
+    {OP_CALL, "call", 0}, {OP_CALLC, "callc", 0}, {OP_TAILCALLC, "tailcallc", 0},
+    {OP_RETURN, "return", 0}, {OP_RETNONE, "retnone", 0}, {OP_HALT, "halt", 0},
+    {OP_DEF, "def", 0}, {OP_ARGC, "argc", 0}, {OP_ARGCS, "argcs", 0},
+    {OP_ARGP, "argp", 0}, {OP_LSTARGC, "lstargc", 0},
+    {OP_TYPE, "type", 0}, {OP_TYPEUP, "typeup", 0}, {OP_CONVERT, "convert", 0},
+    {OP_SIZE, "size", 0}, {OP_PRINT, "print", 0}, {OP_FASTLIB, "fastlib", 0},
+    {OP_REFGET, "refget", 0}, {OP_IDGC, "idgc", 0}, {OP_IEGC, "iegc", 0},
+    {OP_SLV, "slv", 1}, {OP_TRYSLV, "tryslv", 1},
+    {OP_HASHMK, "hashmk", 1}, {OP_HASHADD, "hashadd", 1}, {OP_HASHHASKEY, "hashhaskey", 1},
+    {OP_LSTMK, "lstmk", 1}, {OP_LSTUNPACK, "lstunpack", 1},
+    {OP_LAMBDAMK, "lambdamk", 1}, {OP_FUNCMK, "funcmk", 1},
+};
+#define MLUA_IR_REPORT_OPCODES_COUNT \
+    (sizeof(mlua_ir_report_opcodes) / sizeof(struct mlua_ir_report_opcode))
+
+struct mlua_ir_report_sequence
+{
+    const char *name;
+    size_t length;
+    uint32_t opcodes[3];
+};
+
+/* Matched in order, other instruments may come in between 
+ * as long as the whole sequence fits in the window */
+#define MLUA_IR_REPORT_SEQUENCE_WINDOW 16
+
+static const struct mlua_ir_report_sequence mlua_ir_report_sequences[MLUA_IR_REPORT_SEQUENCE_COUNT] =
+{
+    /* Resolve a name then test a key of it */
+    {"tryslv+hashhaskey", 2, {OP_TRYSLV, OP_HASHHASKEY, 0}},
+    /* Test a key then fetch it, two lookups for one field */
+    {"hashhaskey+refget", 2, {OP_HASHHASKEY, OP_REFGET, 0}},
+    /* Resolve and wrap a callee on every call */
+    {"slv+funcmk+callc", 3, {OP_SLV, OP_FUNCMK, OP_CALLC}},
+    /* Allocate a closure on every call */
+    {"lambdamk+funcmk+callc", 3, {OP_LAMBDAMK, OP_FUNCMK, OP_CALLC}},
+};
+
+static const struct mlua_ir_report_opcode *mlua_ir_report_opcode_lookup(uint32_t opcode)
+{
+    size_t idx;
+
+    for (idx = 0; idx != MLUA_IR_REPORT_OPCODES_COUNT; idx++)
+    {
+        if (mlua_ir_report_opcodes[idx].opcode == opcode)
+        { return &mlua_ir_report_opcodes[idx]; }
+    }
+    return NULL;
+}
+
+static int mlua_ir_report_function_cmp(const void *a, const void *b)
+{
+    const struct mlua_ir_report_function *function_a = a;
+    const struct mlua_ir_report_function *function_b = b;
+
+    if (function_a->instrument_number < function_b->instrument_number) return -1;
+    if (function_a->instrument_number > function_b->instrument_number) return 1;
+    return 0;
+}
+
+static void mlua_ir_report_function_add(struct mlua_ir_report_function *function, \
+        uint32_t opcode, uint32_t instrument_number)
+{
+    size_t idx;
+    const struct mlua_ir_report_sequence *sequence;
+
+    function->instruments++;
+    function->histogram[opcode < MLUA_IR_REPORT_OPCODE_MAX ? opcode : MLUA_IR_REPORT_OPCODE_MAX]++;
+
+    for (idx = 0; idx != MLUA_IR_REPORT_SEQUENCE_COUNT; idx++)
+    {
+        sequence = &mlua_ir_report_sequences[idx];
+        if ((function->sequence_matched[idx] != 0) && \
+                (instrument_number - function->sequence_start[idx] >= MLUA_IR_REPORT_SEQUENCE_WINDOW))
+        { function->sequence_matched[idx] = 0; }
+        if (opcode != sequence->opcodes[function->sequence_matched[idx]])
+        {
+            /* A new start moves the window forward */
+            if (opcode == sequence->opcodes[0]) function->sequence_start[idx] = instrument_number;
+            continue;
+        }
+        if (function->sequence_matched[idx] == 0) function->sequence_start[idx] = instrument_number;
+        if (++function->sequence_matched[idx] == sequence->length)
+        {
+            function->sequences[idx]++;
+            function->sequence_matched[idx] = 0;
+        }
+    }
+}
+
+/* Name of an exported function from the data section */
+static void mlua_ir_report_name_print(FILE *fp, struct multiple_ir *icode, \
+        struct mlua_ir_report_function *function)
+{
+    struct multiple_ir_data_section_item *data_section_item_cur;
+
+    if (function->blank != 0) { fprintf(fp, "(anonymous)"); return; }
+    data_section_item_cur = icode->data_section->begin;
+    while (data_section_item_cur != NULL)
+    {
+        if ((data_section_item_cur->id == function->name) && \
+                (data_section_item_cur->type == MULTIPLE_IR_DATA_SECTION_ITEM_TYPE_IDENTIFIER))
+        {
+            fwrite(data_section_item_cur->ptr, data_section_item_cur->size, 1, fp);
+            return;
+        }
+        data_section_item_cur = data_section_item_cur->next;
+    }
+    fprintf(fp, "(anonymous)");
+}
+
+/* Sum the expensive opcodes once the histogram is complete */
+static void mlua_ir_report_function_finish(struct mlua_ir_report_function *function)
+{
+    size_t idx;
+
+    function->expensive = 0;
+    for (idx = 0; idx != MLUA_IR_REPORT_OPCODES_COUNT; idx++)
+    {
+        if (mlua_ir_report_opcodes[idx].expensive == 0) continue;
+        if (mlua_ir_report_opcodes[idx].opcode >= MLUA_IR_REPORT_OPCODE_MAX) continue;
+        function->expensive += function->histogram[mlua_ir_report_opcodes[idx].opcode];
+    }
+}
+
+static void mlua_ir_report_function_print(FILE *fp, \
+        struct mlua_ir_report_function *function)
+{
+    uint32_t opcode;
+    const struct mlua_ir_report_opcode *opcode_info;
+    size_t idx;
+
+    mlua_ir_report_function_finish(function);
+    fprintf(fp, "  instruments: %lu, expensive: %lu\n", \
+            (unsigned long)function->instruments, \
+            (unsigned long)function->expensive);
+    for (opcode = 0; opcode != MLUA_IR_REPORT_OPCODE_MAX; opcode++)
+    {
+        if (function->histogram[opcode] == 0) continue;
+        opcode_info = mlua_ir_report_opcode_lookup(opcode);
+        if (opcode_info != NULL)
+        {
+            fprintf(fp, "  %-12s%s %lu\n", opcode_info->name, \
+                    opcode_info->expensive != 0 ? "*" : " ", \
+                    (unsigned long)function->histogram[opcode]);
+        }
+        else
+        {
+            fprintf(fp, "  op_%02x         %lu\n", (unsigned int)opcode, \
+                    (unsigned long)function->histogram[opcode]);
+        }
+    }
+    if (function->histogram[MLUA_IR_REPORT_OPCODE_MAX] != 0)
+    {
+        fprintf(fp, "  other         %lu\n", \
+                (unsigned long)function->histogram[MLUA_IR_REPORT_OPCODE_MAX]);
+    }
+    for (idx = 0; idx != MLUA_IR_REPORT_SEQUENCE_COUNT; idx++)
+    {
+        if (function->sequences[idx] == 0) continue;
+        fprintf(fp, "  %s* %lu\n", mlua_ir_report_sequences[idx].name, \
+                (unsigned long)function->sequences[idx]);
+    }
+}
+
+int mlua_ir_report_print(struct multiple_error *err, \
+        FILE *fp, struct multiple_ir *icode)
+{
+    int ret = 0;
+    struct mlua_ir_report_function *functions = NULL;
+    struct mlua_ir_report_function *total = NULL;
+    size_t functions_count = 0;
+    size_t idx, sequence_idx;
+    struct multiple_ir_export_section_item *export_section_item_cur;
+    struct multiple_ir_text_section_item *text_section_item_cur;
+    uint32_t instrument_number;
+    uint32_t opcode;
+
+    /* One extra slot for instruments before the first export */
+    functions_count = icode->export_section->size + 1;
+    if ((functions = (struct mlua_ir_report_function *)calloc( \
+                    functions_count, sizeof(struct mlua_ir_report_function))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+    if ((total = (struct mlua_ir_report_function *)calloc( \
+                    1, sizeof(struct mlua_ir_report_function))) == NULL)
+    { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
+
+    idx = 1;
+    export_section_item_cur = icode->export_section->begin;
+    while ((export_section_item_cur != NULL) && (idx != functions_count))
+    {
+        functions[idx].name = export_section_item_cur->name;
+        functions[idx].blank = export_section_item_cur->blank;
+        functions[idx].instrument_number = export_section_item_cur->instrument_number;
+        functions[idx].args_count = export_section_item_cur->args_count;
+        idx++;
+        export_section_item_cur = export_section_item_cur->next;
+    }
+    qsort(functions + 1, functions_count - 1, \
+            sizeof(struct mlua_ir_report_function), mlua_ir_report_function_cmp);
+
+    /* Functions are laid out one after another,
+     * each runs up to the start of the next */
+    idx = 0;
+    instrument_number = 0;
+    text_section_item_cur = icode->text_section->begin;
+    while (text_section_item_cur != NULL)
+    {
+        while ((idx + 1 != functions_count) && \
+                (functions[idx + 1].instrument_number <= instrument_number))
+        { idx++; }
+        mlua_ir_report_function_add(&functions[idx], text_section_item_cur->opcode, instrument_number);
+        instrument_number++;
+        text_section_item_cur = text_section_item_cur->next;
+    }
+
+    /* A sequence never spans two functions */
+    for (idx = 0; idx != functions_count; idx++)
+    {
+        total->instruments += functions[idx].instruments;
+        for (opcode = 0; opcode != MLUA_IR_REPORT_OPCODE_MAX + 1; opcode++)
+        { total->histogram[opcode] += functions[idx].histogram[opcode]; }
+        for (sequence_idx = 0; sequence_idx != MLUA_IR_REPORT_SEQUENCE_COUNT; sequence_idx++)
+        { total->sequences[sequence_idx] += functions[idx].sequences[sequence_idx]; }
+    }
+
+    for (idx = 0; idx != functions_count; idx++)
+    {
+        if (idx == 0)
+        {
+            if (functions[idx].instruments == 0) continue;
+            fprintf(fp, "(preamble) @0\n");
+        }
+        else
+        {
+            fprintf(fp, "function #%lu @%u, ", \
+                    (unsigned long)idx, \
+                    (unsigned int)functions[idx].instrument_number);
+            mlua_ir_report_name_print(fp, icode, &functions[idx]);
+            fprintf(fp, ", %u argument(s)\n", \
+                    (unsigned int)functions[idx].args_count);
+        }
+        mlua_ir_report_function_print(fp, &functions[idx]);
+    }
+    fprintf(fp, "module: %lu function(s), %lu resource(s)\n", \
+            (unsigned long)(functions_count - 1), \
+            (unsigned long)icode->data_section->size);
+    mlua_ir_report_function_print(fp, total);
+
+    goto done;
+fail:
+done:
+    if (functions != NULL) free(functions);
+    if (total != NULL) free(total);
+    return ret;
+}
+
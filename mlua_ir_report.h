@@ -0,0 +1,67 @@
+/* Multiple Lua Programming Language : IR Report
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_IR_REPORT_H_
+#define _MLUA_IR_REPORT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "multiple_ir.h"
+#include "multiple_err.h"
+
+/* Opcodes below this are counted one by one,
+ * the rest share a single bucket */
+#define MLUA_IR_REPORT_OPCODE_MAX 256
+
+/* Sequences of expensive opcodes the generator tends to emit together */
+enum
+{
+    MLUA_IR_REPORT_SEQUENCE_NAME_FIELD = 0,
+    MLUA_IR_REPORT_SEQUENCE_FIELD_FETCH,
+    MLUA_IR_REPORT_SEQUENCE_CALL_BY_NAME,
+    MLUA_IR_REPORT_SEQUENCE_CLOSURE_CALL,
+    MLUA_IR_REPORT_SEQUENCE_COUNT
+};
+
+struct mlua_ir_report_function
+{
+    uint32_t name;
+    int blank;
+    uint32_t instrument_number;
+    uint32_t args_count;
+
+    size_t instruments;
+    /* Instruments of the opcodes known to be expensive */
+    size_t expensive;
+    size_t histogram[MLUA_IR_REPORT_OPCODE_MAX + 1];
+
+    /* Matches of each sequence, and how far the current match got */
+    size_t sequences[MLUA_IR_REPORT_SEQUENCE_COUNT];
+    size_t sequence_matched[MLUA_IR_REPORT_SEQUENCE_COUNT];
+    uint32_t sequence_start[MLUA_IR_REPORT_SEQUENCE_COUNT];
+};
+
+/* Print per function name, instrument counts, opcode histograms,
+ * expensive instruments and sequences, followed by the module total */
+int mlua_ir_report_print(struct multiple_error *err, \
+        FILE *fp, struct multiple_ir *icode);
+
+#endif
+
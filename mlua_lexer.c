@@ -436,6 +436,38 @@ done:
     return 0;
 }
 
+static void token_patch_keyword(struct token *token_cur)
+{
+    if (token_cur->value != TOKEN_IDENTIFIER) return;
+
+    APPLY_KEYWORD_BEGIN();
+    /* Keywords */
+    APPLY_KEYWORD(token_cur, "and", TOKEN_KEYWORD_AND);
+    APPLY_KEYWORD(token_cur, "break", TOKEN_KEYWORD_BREAK);
+    APPLY_KEYWORD(token_cur, "do", TOKEN_KEYWORD_DO);
+    APPLY_KEYWORD(token_cur, "else", TOKEN_KEYWORD_ELSE);
+    APPLY_KEYWORD(token_cur, "elseif", TOKEN_KEYWORD_ELSEIF);
+    APPLY_KEYWORD(token_cur, "end", TOKEN_KEYWORD_END);
+    APPLY_KEYWORD(token_cur, "false", TOKEN_KEYWORD_FALSE);
+    APPLY_KEYWORD(token_cur, "for", TOKEN_KEYWORD_FOR);
+    APPLY_KEYWORD(token_cur, "function", TOKEN_KEYWORD_FUNCTION);
+    APPLY_KEYWORD(token_cur, "goto", TOKEN_KEYWORD_GOTO);
+    APPLY_KEYWORD(token_cur, "if", TOKEN_KEYWORD_IF);
+    APPLY_KEYWORD(token_cur, "in", TOKEN_KEYWORD_IN);
+    APPLY_KEYWORD(token_cur, "local", TOKEN_KEYWORD_LOCAL);
+    APPLY_KEYWORD(token_cur, "nil", TOKEN_KEYWORD_NIL);
+    APPLY_KEYWORD(token_cur, "not", TOKEN_KEYWORD_NOT);
+    APPLY_KEYWORD(token_cur, "or", TOKEN_KEYWORD_OR);
+    APPLY_KEYWORD(token_cur, "repeat", TOKEN_KEYWORD_REPEAT);
+    APPLY_KEYWORD(token_cur, "return", TOKEN_KEYWORD_RETURN);
+    APPLY_KEYWORD(token_cur, "then", TOKEN_KEYWORD_THEN);
+    APPLY_KEYWORD(token_cur, "true", TOKEN_KEYWORD_TRUE);
+    APPLY_KEYWORD(token_cur, "until", TOKEN_KEYWORD_UNTIL);
+    APPLY_KEYWORD(token_cur, "while", TOKEN_KEYWORD_WHILE);
+
+    APPLY_KEYWORD_END();
+}
+
 static int token_patch(struct multiple_error *err, struct token_list *list)
 {
     struct token *token_cur;
@@ -449,35 +481,7 @@ static int token_patch(struct multiple_error *err, struct token_list *list)
 	token_cur = list->begin;
     while (token_cur != NULL)
     {
-        if (token_cur->value == TOKEN_IDENTIFIER)
-        {
-            APPLY_KEYWORD_BEGIN();
-            /* Keywords */
-            APPLY_KEYWORD(token_cur, "and", TOKEN_KEYWORD_AND);
-            APPLY_KEYWORD(token_cur, "break", TOKEN_KEYWORD_BREAK);
-            APPLY_KEYWORD(token_cur, "do", TOKEN_KEYWORD_DO);
-            APPLY_KEYWORD(token_cur, "else", TOKEN_KEYWORD_ELSE);
-            APPLY_KEYWORD(token_cur, "elseif", TOKEN_KEYWORD_ELSEIF);
-            APPLY_KEYWORD(token_cur, "end", TOKEN_KEYWORD_END);
-            APPLY_KEYWORD(token_cur, "false", TOKEN_KEYWORD_FALSE);
-            APPLY_KEYWORD(token_cur, "for", TOKEN_KEYWORD_FOR);
-            APPLY_KEYWORD(token_cur, "function", TOKEN_KEYWORD_FUNCTION);
-            APPLY_KEYWORD(token_cur, "goto", TOKEN_KEYWORD_GOTO);
-            APPLY_KEYWORD(token_cur, "if", TOKEN_KEYWORD_IF);
-            APPLY_KEYWORD(token_cur, "in", TOKEN_KEYWORD_IN);
-            APPLY_KEYWORD(token_cur, "local", TOKEN_KEYWORD_LOCAL);
-            APPLY_KEYWORD(token_cur, "nil", TOKEN_KEYWORD_NIL);
-            APPLY_KEYWORD(token_cur, "not", TOKEN_KEYWORD_NOT);
-            APPLY_KEYWORD(token_cur, "or", TOKEN_KEYWORD_OR);
-            APPLY_KEYWORD(token_cur, "repeat", TOKEN_KEYWORD_REPEAT);
-            APPLY_KEYWORD(token_cur, "return", TOKEN_KEYWORD_RETURN);
-            APPLY_KEYWORD(token_cur, "then", TOKEN_KEYWORD_THEN);
-            APPLY_KEYWORD(token_cur, "true", TOKEN_KEYWORD_TRUE);
-            APPLY_KEYWORD(token_cur, "until", TOKEN_KEYWORD_UNTIL);
-            APPLY_KEYWORD(token_cur, "while", TOKEN_KEYWORD_WHILE);
-
-            APPLY_KEYWORD_END();
-        }
+        token_patch_keyword(token_cur);
         token_cur = token_cur->next;
     }
     return 0;
@@ -554,13 +558,355 @@ fail:
     return ret;
 }
 
+static struct mlua_token_stream *mlua_token_stream_new(struct multiple_error *err)
+{
+    struct mlua_token_stream *new_stream = NULL;
+    size_t i;
+
+    if ((new_stream = (struct mlua_token_stream *)malloc(sizeof(struct mlua_token_stream))) == NULL)
+    { return NULL; }
+    new_stream->err = err;
+    new_stream->buf = NULL;
+    new_stream->buf_start = 0;
+    new_stream->buf_end = 0;
+    new_stream->eof = 0;
+    new_stream->fp = NULL;
+    new_stream->buf_owned = NULL;
+    new_stream->buf_size = 0;
+    new_stream->pos_col = 1;
+    new_stream->pos_ln = 1;
+    new_stream->eol_type = EOL_UNIX;
+    new_stream->eol_detected = 0;
+    for (i = 0; i != MLUA_TOKEN_STREAM_RING_SIZE; i++)
+    {
+        new_stream->ring[i].token.value = TOKEN_UNDEFINED;
+        new_stream->ring[i].token.str = NULL;
+        new_stream->ring[i].token.len = 0;
+        new_stream->ring[i].token.pos_col = 0;
+        new_stream->ring[i].token.pos_ln = 0;
+        new_stream->ring[i].token.prev = NULL;
+        new_stream->ring[i].token.next = NULL;
+        new_stream->ring[i].stream = new_stream;
+    }
+    new_stream->ring_next = 0;
+    new_stream->ring_used = 0;
+    new_stream->last = NULL;
+    new_stream->count = 0;
+    new_stream->ret = 0;
+
+    return new_stream;
+}
+
+int mlua_token_stream_new_from_memory(struct multiple_error *err, \
+        struct mlua_token_stream **stream_out, \
+        const char *data, const size_t data_len)
+{
+    struct mlua_token_stream *new_stream = NULL;
+    int eol_type;
+
+    *stream_out = NULL;
+
+    if ((eol_type = eol_detect(err, data, data_len)) < 0)
+    { return -MULTIPLE_ERR_LEXICAL; }
+
+    if ((new_stream = mlua_token_stream_new(err)) == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        return -MULTIPLE_ERR_MALLOC;
+    }
+    new_stream->buf = data;
+    new_stream->buf_end = data_len;
+    new_stream->eof = 1;
+    new_stream->eol_type = eol_type;
+    new_stream->eol_detected = 1;
+
+    *stream_out = new_stream;
+
+    return 0;
+}
+
+int mlua_token_stream_new_from_file(struct multiple_error *err, \
+        struct mlua_token_stream **stream_out, \
+        FILE *fp)
+{
+    struct mlua_token_stream *new_stream = NULL;
+
+    *stream_out = NULL;
+
+    if (fp == NULL)
+    {
+        MULTIPLE_ERROR_NULL_PTR();
+        return -MULTIPLE_ERR_NULL_PTR;
+    }
+    if ((new_stream = mlua_token_stream_new(err)) == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        return -MULTIPLE_ERR_MALLOC;
+    }
+    if ((new_stream->buf_owned = (char *)malloc(sizeof(char) * MLUA_TOKEN_STREAM_CHUNK_SIZE)) == NULL)
+    {
+        free(new_stream);
+        MULTIPLE_ERROR_MALLOC();
+        return -MULTIPLE_ERR_MALLOC;
+    }
+    new_stream->buf = new_stream->buf_owned;
+    new_stream->buf_size = MLUA_TOKEN_STREAM_CHUNK_SIZE;
+    new_stream->fp = fp;
+
+    *stream_out = new_stream;
+
+    return 0;
+}
+
+int mlua_token_stream_destroy(struct mlua_token_stream *stream)
+{
+    size_t i;
+
+    if (stream == NULL) return -MULTIPLE_ERR_NULL_PTR;
+
+    for (i = 0; i != MLUA_TOKEN_STREAM_RING_SIZE; i++)
+    {
+        if (stream->ring[i].token.str != NULL) free(stream->ring[i].token.str);
+    }
+    if (stream->buf_owned != NULL) free(stream->buf_owned);
+    free(stream);
+
+    return 0;
+}
+
+/* Read the next chunk of source code in file mode, 
+ * the buffer only grows when one token fills it completely */
+static int mlua_token_stream_fill(struct mlua_token_stream *stream)
+{
+    struct multiple_error *err = stream->err;
+    size_t remain = stream->buf_end - stream->buf_start;
+    size_t bytes_read;
+    char *new_buf;
+
+    if (stream->buf_start != 0)
+    {
+        memmove(stream->buf_owned, stream->buf_owned + stream->buf_start, remain);
+        stream->buf_start = 0;
+        stream->buf_end = remain;
+    }
+    if (stream->buf_end == stream->buf_size)
+    {
+        if ((new_buf = (char *)realloc(stream->buf_owned, sizeof(char) * stream->buf_size * 2)) == NULL)
+        {
+            MULTIPLE_ERROR_MALLOC();
+            return -MULTIPLE_ERR_MALLOC;
+        }
+        stream->buf_owned = new_buf;
+        stream->buf = new_buf;
+        stream->buf_size *= 2;
+    }
+
+    bytes_read = fread(stream->buf_owned + stream->buf_end, 1, \
+            stream->buf_size - stream->buf_end, stream->fp);
+    stream->buf_end += bytes_read;
+    if (bytes_read == 0)
+    {
+        if (ferror(stream->fp))
+        {
+            multiple_error_update(err, -MULTIPLE_ERR_LEXICAL, "error: reading source code failed");
+            return -MULTIPLE_ERR_LEXICAL;
+        }
+        stream->eof = 1;
+    }
+
+    if ((stream->eol_detected == 0) && \
+            ((stream->eof != 0) || (stream->buf_end == stream->buf_size)))
+    {
+        if ((stream->eol_type = eol_detect(err, stream->buf, stream->buf_end)) < 0)
+        { return -MULTIPLE_ERR_LEXICAL; }
+        stream->eol_detected = 1;
+    }
+
+    return 0;
+}
+
+/* A token never ends inside a chunk that is followed by more data 
+ * unless it ends right after a whitespace or EOL, so scanning stops there 
+ * to avoid splitting operators or multi-byte characters */
+static const char *mlua_token_stream_safe_endp(struct mlua_token_stream *stream, \
+        const char *p, const char *endp)
+{
+    char ch;
+
+    if (stream->eof != 0) return endp;
+
+    while (endp != p)
+    {
+        ch = *(endp - 1);
+        if ((ch == ' ') || (ch == '\t') || (ch == '\n') || \
+                ((ch == '\r') && (stream->eol_type != EOL_DOS)))
+        { return endp; }
+        endp--;
+    }
+    return p;
+}
+
+/* Take the oldest slot of the ring for a new token */
+static struct token *mlua_token_stream_slot(struct mlua_token_stream *stream)
+{
+    struct token *slot = &stream->ring[stream->ring_next].token;
+
+    if (stream->ring_used == MLUA_TOKEN_STREAM_RING_SIZE)
+    {
+        /* Recycle, the parser never looks this far back */
+        if (slot->next != NULL) slot->next->prev = NULL;
+        if (slot->str != NULL) free(slot->str);
+    }
+    else
+    {
+        stream->ring_used++;
+    }
+    stream->ring_next = (stream->ring_next + 1) % MLUA_TOKEN_STREAM_RING_SIZE;
+    stream->count++;
+
+    slot->str = NULL;
+    slot->len = 0;
+    slot->prev = stream->last;
+    slot->next = NULL;
+    if (stream->last != NULL) stream->last->next = slot;
+    stream->last = slot;
+
+    return slot;
+}
+
+static void mlua_token_stream_finish(struct mlua_token_stream *stream)
+{
+    struct token *slot = mlua_token_stream_slot(stream);
+
+    slot->value = TOKEN_FINISH;
+    slot->pos_col = stream->pos_col;
+    slot->pos_ln = stream->pos_ln;
+}
+
+/* Append the next non-whitespace token to the stream */
+static int mlua_token_stream_pull(struct mlua_token_stream *stream)
+{
+    int ret = 0;
+    struct multiple_error *err = stream->err;
+    struct token token_template;
+    struct token *slot;
+    const char *p, *endp, *safe_endp;
+    uint32_t pos_col, pos_ln;
+    size_t move_on;
+
+    if (stream->ret != 0) goto fail;
+
+    for (;;)
+    {
+        if ((stream->eol_detected == 0) || \
+                ((stream->eof == 0) && (stream->buf_start == stream->buf_end)))
+        {
+            if ((ret = mlua_token_stream_fill(stream)) != 0) goto fail;
+            continue;
+        }
+
+        p = stream->buf + stream->buf_start;
+        endp = stream->buf + stream->buf_end;
+        if (p == endp)
+        {
+            /* End of source code */
+            mlua_token_stream_finish(stream);
+            return 0;
+        }
+        safe_endp = mlua_token_stream_safe_endp(stream, p, endp);
+        if (safe_endp == p)
+        {
+            if ((ret = mlua_token_stream_fill(stream)) != 0) goto fail;
+            continue;
+        }
+
+        pos_col = stream->pos_col;
+        pos_ln = stream->pos_ln;
+        if ((ret = eat_token(err, &token_template, p, safe_endp, \
+                        &pos_col, &pos_ln, stream->eol_type, &move_on)) != 0)
+        { goto fail; }
+
+        if ((move_on == 0) || (p + move_on == safe_endp))
+        {
+            if (stream->eof == 0)
+            {
+                /* The token may continue in the next chunk */
+                if ((ret = mlua_token_stream_fill(stream)) != 0) goto fail;
+                continue;
+            }
+            if (move_on == 0)
+            {
+                multiple_error_update(err, -MULTIPLE_ERR_LEXICAL, \
+                        "%d:%d: undefined token", pos_ln, pos_col);
+                ret = -MULTIPLE_ERR_LEXICAL;
+                goto fail;
+            }
+        }
+
+        /* Move on */
+        stream->pos_col = pos_col;
+        stream->pos_ln = pos_ln;
+        stream->buf_start += move_on;
+
+        if (token_template.value != TOKEN_WHITESPACE) break;
+    }
+
+    token_patch_keyword(&token_template);
+
+    /* Tokens must outlive the chunk they were scanned from */
+    slot = mlua_token_stream_slot(stream);
+    if ((slot->str = (char *)malloc(sizeof(char) * (token_template.len + 1))) == NULL)
+    {
+        MULTIPLE_ERROR_MALLOC();
+        ret = -MULTIPLE_ERR_MALLOC;
+        slot->value = TOKEN_FINISH;
+        stream->ret = ret;
+        return ret;
+    }
+    memcpy(slot->str, token_template.str, token_template.len);
+    slot->str[token_template.len] = '\0';
+    slot->len = token_template.len;
+    slot->value = token_template.value;
+    slot->pos_col = token_template.pos_col;
+    slot->pos_ln = token_template.pos_ln;
+
+    return 0;
+fail:
+    if (stream->ret == 0) stream->ret = ret;
+    mlua_token_stream_finish(stream);
+    return stream->ret;
+}
+
+struct token *mlua_token_stream_first(struct mlua_token_stream *stream)
+{
+    if (stream->last == NULL) 
+    {
+        mlua_token_stream_pull(stream);
+    }
+    return &stream->ring[(stream->ring_next + MLUA_TOKEN_STREAM_RING_SIZE - stream->ring_used) % MLUA_TOKEN_STREAM_RING_SIZE].token;
+}
+
+struct token *mlua_token_next(struct token *token)
+{
+    struct mlua_token_stream_token *stream_token;
+
+    if (token->next != NULL) return token->next;
+    if (token->value == TOKEN_FINISH) return NULL;
+
+    /* Only the newest token of a stream has no successor yet */
+    stream_token = (struct mlua_token_stream_token *)token;
+    mlua_token_stream_pull(stream_token->stream);
+
+    return token->next;
+}
+
 struct token_value_name_tbl_item
 {
     const int value;
     const char *name;
 };
 
-static struct token_value_name_tbl_item token_value_name_tbl_items[] = 
+static const struct token_value_name_tbl_item token_value_name_tbl_items[] = 
 {
 };
 #define TOKEN_VALUE_NAME_TBL_ITEMS_COUNT (sizeof(token_value_name_tbl_items)/sizeof(struct token_value_name_tbl_item))
@@ -72,5 +72,72 @@ int mlua_token_name(char **token_name, size_t *token_name_len, const int value);
 /* Lexical scan source code */
 int mlua_tokenize(struct multiple_error *err, struct token_list **list_out, const char *data, const size_t data_len);
 
+
+/* Token Stream 
+ * Tokens are produced on demand while the parser walks them, 
+ * only the latest MLUA_TOKEN_STREAM_RING_SIZE tokens stay alive */
+
+#define MLUA_TOKEN_STREAM_RING_SIZE 16
+#define MLUA_TOKEN_STREAM_CHUNK_SIZE 4096
+
+struct mlua_token_stream;
+
+struct mlua_token_stream_token
+{
+    /* Must be the first member */
+    struct token token;
+    struct mlua_token_stream *stream;
+};
+
+struct mlua_token_stream
+{
+    struct multiple_error *err;
+
+    /* Source data, points to the caller's data in memory mode 
+     * or to 'buf_owned' in file mode */
+    const char *buf;
+    size_t buf_start;
+    size_t buf_end;
+    int eof;
+
+    /* File mode */
+    FILE *fp;
+    char *buf_owned;
+    size_t buf_size;
+
+    /* Lexical state */
+    uint32_t pos_col, pos_ln;
+    int eol_type;
+    int eol_detected;
+
+    /* Lookahead ring */
+    struct mlua_token_stream_token ring[MLUA_TOKEN_STREAM_RING_SIZE];
+    size_t ring_next;
+    size_t ring_used;
+    struct token *last;
+
+    /* Tokens pulled so far */
+    size_t count;
+
+    /* Error of the first failed pull */
+    int ret;
+};
+
+int mlua_token_stream_new_from_memory(struct multiple_error *err, \
+        struct mlua_token_stream **stream_out, \
+        const char *data, const size_t data_len);
+int mlua_token_stream_new_from_file(struct multiple_error *err, \
+        struct mlua_token_stream **stream_out, \
+        FILE *fp);
+int mlua_token_stream_destroy(struct mlua_token_stream *stream);
+
+/* The first token of the stream */
+struct token *mlua_token_stream_first(struct mlua_token_stream *stream);
+
+/* Next token, pulls from the stream when 'token' belongs to one, 
+ * returns NULL after TOKEN_FINISH. 
+ * A failed pull yields TOKEN_FINISH and records the error in the stream */
+struct token *mlua_token_next(struct token *token);
+
 #endif
 
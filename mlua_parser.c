@@ -38,7 +38,7 @@ struct priority_item
     const int left;
     const int right;
 };
-static struct priority_item priority_items[] = 
+static const struct priority_item priority_items[] = 
 {
     {6, 6},
     {7, 7},
@@ -51,7 +51,7 @@ static struct priority_item priority_items[] =
 };
 #define UNARY_PRIORITY 8
 
-static struct priority_item *mlua_parse_expression_priority(struct token *token_cur)
+static const struct priority_item *mlua_parse_expression_priority(struct token *token_cur)
 {
     switch (token_cur->value)
     {
@@ -141,7 +141,7 @@ static int mlua_parse_par_list(struct multiple_error *err, \
         if ((new_par = mlua_ast_par_new()) == NULL)
         { goto fail; }
         new_par->name = token_clone(token_cur);
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         mlua_ast_par_list_append(new_par_list, new_par);
         new_par = NULL;
     }
@@ -175,15 +175,15 @@ static int mlua_parse_par_list(struct multiple_error *err, \
             if (token_cur->value == TOKEN_OP_TRI_DOT)
             {
                 /* Final one */
-                token_cur = token_cur->next;
+                token_cur = mlua_token_next(token_cur);
                 break;
             }
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             /* Test next */
             if (token_cur->value == ',')
             {
-                token_cur = token_cur->next;
+                token_cur = mlua_token_next(token_cur);
             }
             else
             {
@@ -232,7 +232,7 @@ static int mlua_parse_field(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         /* Skip '=' */
         if (token_cur->value != '=')
         {
@@ -242,7 +242,7 @@ static int mlua_parse_field(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         /* value */
         if ((ret = mlua_parse_expression(err, &new_field->u.array->value, &token_cur)) != 0)
         { goto fail; }
@@ -266,7 +266,7 @@ static int mlua_parse_field(struct multiple_error *err, \
         }
         if ((new_field->u.property->name->name = token_clone(token_cur)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         /* Skip '=' */
         if (token_cur->value != '=')
         {
@@ -276,7 +276,7 @@ static int mlua_parse_field(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         /* value */
         if ((ret = mlua_parse_expression(err, &new_field->u.property->value, &token_cur)) != 0)
         { goto fail; }
@@ -333,7 +333,7 @@ static int mlua_parse_fieldlist(struct multiple_error *err, \
                 (token_cur->value == ';'))
         {
             /* Skip ',' or ';' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             if (token_cur->value == '}') break;
 
@@ -372,7 +372,7 @@ static int mlua_parse_arguments(struct multiple_error *err, \
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
         new_args->u.str = token_clone(token_cur);
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
     }
     else if (token_cur->value == '(')
     {
@@ -381,14 +381,14 @@ static int mlua_parse_arguments(struct multiple_error *err, \
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
         /* Skip '(' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         /* explist */
         if ((ret = mlua_parse_expression_list(err, &new_args->u.explist, &token_cur)) != 0)
         { goto fail; }
 
         /* Skip ')' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
     }
     else if (token_cur->value == '{')
     {
@@ -428,7 +428,7 @@ static int mlua_parse_expression_primary(struct multiple_error *err, \
             { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
             /* Skip '(' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             if ((ret = mlua_parse_expression(err, &new_exp->u.primary->u.exp, &token_cur)) != 0)
             { goto fail; }
@@ -442,7 +442,7 @@ static int mlua_parse_expression_primary(struct multiple_error *err, \
                 ret = -MULTIPLE_ERR_PARSING;
                 goto fail;
             }
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             break;
 
@@ -455,7 +455,7 @@ static int mlua_parse_expression_primary(struct multiple_error *err, \
 
             if ((new_exp->u.primary->u.name = token_clone(token_cur)) == NULL)
             { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             break;
 
@@ -497,7 +497,7 @@ static int mlua_parse_expression_suffixed(struct multiple_error *err, \
         if (token_cur->value == '.')
         {
             /* Skip '.' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             if ((new_exp2 = mlua_ast_expression_new(MLUA_AST_EXPRESSION_TYPE_SUFFIXED)) == NULL)
             { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -517,7 +517,7 @@ static int mlua_parse_expression_suffixed(struct multiple_error *err, \
             { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
             /* Skip member name */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             new_exp2->u.suffixed->sub = new_exp;
             new_exp = new_exp2; new_exp2 = NULL;
@@ -525,7 +525,7 @@ static int mlua_parse_expression_suffixed(struct multiple_error *err, \
         else if (token_cur->value == '[')
         {
             /* Skip '[' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             if ((new_exp2 = mlua_ast_expression_new(MLUA_AST_EXPRESSION_TYPE_SUFFIXED)) == NULL)
             { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -540,7 +540,7 @@ static int mlua_parse_expression_suffixed(struct multiple_error *err, \
             { goto fail; }
 
             /* Skip ']' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             new_exp2->u.suffixed->sub = new_exp;
             new_exp = new_exp2; new_exp2 = NULL;
@@ -636,7 +636,7 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
     if (tblctor != 0)
     {
         /* Skip '{' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((new_exp = mlua_ast_expression_new(MLUA_AST_EXPRESSION_TYPE_TBLCTOR)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -657,12 +657,12 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
     }
     else if (factor_function != 0)
     {
         /* Skip 'function' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((new_exp = mlua_ast_expression_new(MLUA_AST_EXPRESSION_TYPE_FUNDEF)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -678,7 +678,7 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         if ((ret = mlua_parse_par_list(err, \
                         &new_exp->u.fundef->pars, \
                         &token_cur)) != 0)
@@ -691,7 +691,7 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         /* body */
         if ((ret = mlua_parse_statement_list(err, \
@@ -708,7 +708,7 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
             ret = -MULTIPLE_ERR_PARSING;
             goto fail;
         }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
     }
     else if (suffixed_branch != 0)
     {
@@ -724,7 +724,7 @@ static int mlua_parse_expression_simple(struct multiple_error *err, \
         if ((new_exp->u.factor = mlua_ast_expression_factor_new(factor_type)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
         new_exp->u.factor->token = token_clone(token_cur);
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
     }
 
     *exp_out = new_exp;
@@ -749,7 +749,7 @@ static int mlua_parse_expression_unop(struct multiple_error *err, \
     if ((new_exp_unop = mlua_ast_expression_unop_new()) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
     new_exp_unop->op = token_clone(token_cur);
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((ret = mlua_parse_expression_sub(err, &new_exp_unop->sub, &token_cur, UNARY_PRIORITY)) != 0)
     { goto fail; }
@@ -773,7 +773,7 @@ static int mlua_parse_expression_sub(struct multiple_error *err, \
     struct token *token_cur = *token_cur_io;
     struct mlua_ast_expression *new_exp = NULL;
     struct mlua_ast_expression *new_exp_bin = NULL;
-    struct priority_item *pi;
+    const struct priority_item *pi;
 
     switch (token_cur->value)
     {
@@ -803,7 +803,7 @@ static int mlua_parse_expression_sub(struct multiple_error *err, \
         new_exp_bin->u.binop->left = new_exp; new_exp = NULL;
 
         /* Skip infix operator */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((ret = mlua_parse_expression_sub(err, \
                         &new_exp_bin->u.binop->right, \
@@ -873,7 +873,7 @@ static int mlua_parse_expression_list(struct multiple_error *err, \
         while ((token_cur != NULL) && (token_cur->value == ','))
         {
             /* Skip the ',' */
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
 
             if ((ret = mlua_parse_expression(err, &new_exp, &token_cur)) != 0)
             { goto fail; }
@@ -1011,7 +1011,7 @@ static int mlua_parse_statement_elseif(struct multiple_error *err, \
     while (token_cur->value == TOKEN_KEYWORD_ELSEIF)
     {
         /* Skip 'elseif' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((new_stmt_elseif = mlua_ast_statement_elseif_new()) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1032,7 +1032,7 @@ static int mlua_parse_statement_elseif(struct multiple_error *err, \
         }
 
         /* Skip 'then' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         /* then block */
         if ((ret = mlua_parse_statement_list(err, \
@@ -1070,7 +1070,7 @@ static int mlua_parse_statement_if(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'if' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_IF)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1094,7 +1094,7 @@ static int mlua_parse_statement_if(struct multiple_error *err, \
     }
 
     /* Skip 'then' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* then block */
     if ((ret = mlua_parse_statement_list(err, \
@@ -1105,7 +1105,7 @@ static int mlua_parse_statement_if(struct multiple_error *err, \
     if (token_cur->value == TOKEN_KEYWORD_ELSE)
     {
         /* Skip 'else' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         /* else block */
         if ((ret = mlua_parse_statement_list(err, \
@@ -1129,7 +1129,7 @@ static int mlua_parse_statement_if(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1151,7 +1151,7 @@ static int mlua_parse_statement_while(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'while' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_WHILE)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1175,7 +1175,7 @@ static int mlua_parse_statement_while(struct multiple_error *err, \
     }
 
     /* Skip 'do' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* block */
     if ((ret = mlua_parse_statement_list(err, \
@@ -1201,7 +1201,7 @@ static int mlua_parse_statement_while(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1223,7 +1223,7 @@ static int mlua_parse_statement_repeat(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'repeat' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_REPEAT)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1247,7 +1247,7 @@ static int mlua_parse_statement_repeat(struct multiple_error *err, \
     }
 
     /* Skip 'until' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* exp */
     if ((ret = mlua_parse_expression(err, \
@@ -1275,7 +1275,7 @@ static int mlua_parse_statement_do(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'do' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_DO)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1307,7 +1307,7 @@ static int mlua_parse_statement_do(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1329,7 +1329,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'for' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* stat -> 'for' name '=' exp ',' exp [',' exp] 'do' block 'end' */
 
@@ -1352,7 +1352,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
     if ((new_stmt->u.stmt_for->name->name = token_clone(token_cur)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* = */
     if (token_cur->value != '=') 
@@ -1363,7 +1363,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* exp1 */
     if ((ret = mlua_parse_expression(err, \
@@ -1380,7 +1380,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* exp2 */
     if ((ret = mlua_parse_expression(err, \
@@ -1391,7 +1391,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
     /* [, exp3] */
     if (token_cur->value == ',') 
     {
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         if ((ret = mlua_parse_expression(err, \
                         &new_stmt->u.stmt_for->exp3, \
                         &token_cur)) != 0)
@@ -1413,7 +1413,7 @@ static int mlua_parse_statement_for(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1435,7 +1435,7 @@ static int mlua_parse_statement_break(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'break' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_BREAK)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1460,7 +1460,7 @@ static int mlua_parse_statement_label(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip first '::' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_LABEL)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1479,10 +1479,10 @@ static int mlua_parse_statement_label(struct multiple_error *err, \
     /* Label name */
     if ((new_stmt->u.stmt_label->name = token_clone(token_cur)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* Skip second '::' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1504,7 +1504,7 @@ static int mlua_parse_statement_goto(struct multiple_error *err, \
     struct mlua_ast_statement *new_stmt = NULL;
 
     /* Skip 'goto' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_GOTO)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1523,7 +1523,7 @@ static int mlua_parse_statement_goto(struct multiple_error *err, \
     /* Label name */
     if ((new_stmt->u.stmt_goto->name = token_clone(token_cur)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1546,7 +1546,7 @@ static int mlua_parse_statement_local(struct multiple_error *err, \
     struct mlua_ast_expression *new_ast_exp = NULL;
 
     /* Skip 'local' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     if ((new_stmt = mlua_ast_statement_new(MLUA_AST_STATEMENT_TYPE_LOCAL)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
@@ -1577,11 +1577,11 @@ static int mlua_parse_statement_local(struct multiple_error *err, \
         new_ast_name = NULL;
 
         /* Skip the scanned name */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if (token_cur->value == ',')
         {
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
         }
         else if (token_cur->value == '=')
         {
@@ -1602,7 +1602,7 @@ static int mlua_parse_statement_local(struct multiple_error *err, \
     if ((token_cur != NULL) && (token_cur->value == '='))
     {
         /* Skip '=' */ 
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         /* At least one exp */
         if ((ret = mlua_parse_expression(err, \
@@ -1615,7 +1615,7 @@ static int mlua_parse_statement_local(struct multiple_error *err, \
         while ((token_cur != NULL) && (token_cur->value == ','))
         {
             /* Skip ',' */
-            token_cur = token_cur->next; 
+            token_cur = mlua_token_next(token_cur); 
             /* Parse the next expression */
             if ((ret = mlua_parse_expression(err, \
                             &new_ast_exp, \
@@ -1669,14 +1669,14 @@ static int mlua_parse_funcname(struct multiple_error *err, \
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
     if ((new_name->name = token_clone(token_cur)) == NULL)
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
     mlua_ast_namelist_append(new_funcname->name_list, new_name);
     new_name = NULL;
 
     while (token_cur->value == '.')
     {
         /* Skip '.' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if (token_cur->value != TOKEN_IDENTIFIER)
         {
@@ -1691,7 +1691,7 @@ static int mlua_parse_funcname(struct multiple_error *err, \
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
         if ((new_name->name = token_clone(token_cur)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         mlua_ast_namelist_append(new_funcname->name_list, new_name);
         new_name = NULL;
     }
@@ -1699,7 +1699,7 @@ static int mlua_parse_funcname(struct multiple_error *err, \
     if (token_cur->value == ':')
     {
         /* Skip ':' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if (token_cur->value != TOKEN_IDENTIFIER)
         {
@@ -1714,7 +1714,7 @@ static int mlua_parse_funcname(struct multiple_error *err, \
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
         if ((new_name->name = token_clone(token_cur)) == NULL)
         { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
         new_funcname->member = new_name; new_name = NULL;
     }
 
@@ -1753,12 +1753,12 @@ static int mlua_parse_statement_fundef(struct multiple_error *err, \
     {
         case MLUA_PARSE_STATEMENT_FUNDEF_GLOBAL:
             /* Skip 'function' */
-            token_cur = token_cur->next; 
+            token_cur = mlua_token_next(token_cur); 
             new_stmt->u.stmt_fundef->local = 0;
             break;
         case MLUA_PARSE_STATEMENT_FUNDEF_LOCAL:
             /* Skip 'local function' */
-            token_cur = token_cur->next->next; 
+            token_cur = mlua_token_next(mlua_token_next(token_cur)); 
             new_stmt->u.stmt_fundef->local = 1;
             break;
     }
@@ -1777,7 +1777,7 @@ static int mlua_parse_statement_fundef(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
     if ((ret = mlua_parse_par_list(err, \
                     &new_stmt->u.stmt_fundef->parameters, \
                     &token_cur)) != 0)
@@ -1790,7 +1790,7 @@ static int mlua_parse_statement_fundef(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* body */
     if ((ret = mlua_parse_statement_list(err, \
@@ -1807,7 +1807,7 @@ static int mlua_parse_statement_fundef(struct multiple_error *err, \
         ret = -MULTIPLE_ERR_PARSING;
         goto fail;
     }
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     *stmt_out = new_stmt;
 
@@ -1838,7 +1838,7 @@ static int mlua_parse_statement_return(struct multiple_error *err, \
     { MULTIPLE_ERROR_MALLOC(); ret = -MULTIPLE_ERR_MALLOC; goto fail; }
 
     /* Skip 'local' */
-    token_cur = token_cur->next;
+    token_cur = mlua_token_next(token_cur);
 
     /* explist */
 
@@ -1853,7 +1853,7 @@ static int mlua_parse_statement_return(struct multiple_error *err, \
 
         if (token_cur->value == ',')
         {
-            token_cur = token_cur->next;
+            token_cur = mlua_token_next(token_cur);
         }
         else
         {
@@ -1887,7 +1887,7 @@ static int mlua_parse_statement_assignment(struct multiple_error *err, \
         /* assignment -> ',' suffixedexpr assignment */
 
         /* Skip ',' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((ret = mlua_parse_expression_suffixed(err, \
                         &new_exp, \
@@ -1908,7 +1908,7 @@ static int mlua_parse_statement_assignment(struct multiple_error *err, \
         /* assignment -> '=' explist */
 
         /* Skip '=' */
-        token_cur = token_cur->next;
+        token_cur = mlua_token_next(token_cur);
 
         if ((ret = mlua_parse_expression_list(err,\
                         &stmt_assign->u.stmt_assignment->explist, \
@@ -2091,8 +2091,8 @@ static int mlua_parse_statement(struct multiple_error *err, \
     }
     else if (token_cur->value == TOKEN_KEYWORD_LOCAL)
     {
-        if ((token_cur->next != NULL) && \
-                (token_cur->next->value == TOKEN_KEYWORD_FUNCTION))
+        if ((mlua_token_next(token_cur) != NULL) && \
+                (mlua_token_next(token_cur)->value == TOKEN_KEYWORD_FUNCTION))
         {
             /* Local Function */
             if ((ret = mlua_parse_statement_fundef(err, \
@@ -2233,3 +2233,28 @@ done:
     return ret;
 }
 
+int mlua_parse_stream(struct multiple_error *err, \
+        struct mlua_ast_program **program_out, \
+        struct mlua_token_stream *stream)
+{
+    int ret = 0;
+    struct mlua_ast_program *new_program = NULL;
+    struct token *token_cur = mlua_token_stream_first(stream);
+
+    *program_out = NULL;
+
+    ret = mlua_parse_program(err, \
+            &new_program, \
+            &token_cur);
+    /* Lexical errors show up as a premature end of the stream */
+    if (stream->ret != 0) ret = stream->ret;
+    if (ret != 0) { goto fail; }
+
+    *program_out = new_program;
+
+    goto done;
+fail:
+    if (new_program != NULL) { mlua_ast_program_destroy(new_program); }
+done:
+    return ret;
+}
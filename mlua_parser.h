@@ -29,5 +29,11 @@ int mlua_parse(struct multiple_error *err, \
         struct mlua_ast_program **program_out, \
         struct token_list *list);
 
+/* Parse tokens pulled from a stream, 
+ * only a bounded lookahead of tokens is alive at a time */
+int mlua_parse_stream(struct multiple_error *err, \
+        struct mlua_ast_program **program_out, \
+        struct mlua_token_stream *stream);
+
 #endif
 
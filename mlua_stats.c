@@ -0,0 +1,121 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "selfcheck.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "mlua_stats.h"
+
+static const char *mlua_stats_phase_names[MLUA_STATS_PHASE_COUNT] =
+{
+    "tokenize",
+    "parse",
+    "optimize",
+    "irgen",
+    "merge",
+};
+
+void mlua_stats_init(struct mlua_stats *stats)
+{
+    memset(stats, 0, sizeof(struct mlua_stats));
+}
+
+const char *mlua_stats_phase_name(enum mlua_stats_phase phase)
+{
+    if ((int)phase < 0 || phase >= MLUA_STATS_PHASE_COUNT) return NULL;
+    return mlua_stats_phase_names[phase];
+}
+
+static double mlua_stats_clock(clockid_t clock_id)
+{
+    struct timespec ts;
+
+    if (clock_gettime(clock_id, &ts) != 0) return 0.0;
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Bytes in use by the allocator, the whole process shares it,
+ * so phases of concurrent batch workers blur into each other */
+static int64_t mlua_stats_heap(void)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+    struct mallinfo2 mi = mallinfo2();
+    return (int64_t)mi.uordblks;
+#else
+    return 0;
+#endif
+}
+
+void mlua_stats_probe_begin(struct mlua_stats *stats, struct mlua_stats_probe *probe)
+{
+    if (stats == NULL) return;
+    probe->heap = mlua_stats_heap();
+    probe->cpu = mlua_stats_clock(CLOCK_THREAD_CPUTIME_ID);
+    probe->wall = mlua_stats_clock(CLOCK_MONOTONIC);
+}
+
+void mlua_stats_probe_end(struct mlua_stats *stats, struct mlua_stats_probe *probe, \
+        enum mlua_stats_phase phase)
+{
+    struct mlua_stats_phase_record *record;
+
+    if (stats == NULL) return;
+    record = &stats->phases[phase];
+    record->wall += mlua_stats_clock(CLOCK_MONOTONIC) - probe->wall;
+    record->cpu += mlua_stats_clock(CLOCK_THREAD_CPUTIME_ID) - probe->cpu;
+    record->heap_growth += mlua_stats_heap() - probe->heap;
+    record->runs++;
+}
+
+int mlua_stats_json_print(FILE *fp, struct mlua_stats *stats)
+{
+    int idx;
+    struct mlua_stats_phase_record *record;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"phases\": {\n");
+    for (idx = 0; idx != MLUA_STATS_PHASE_COUNT; idx++)
+    {
+        record = &stats->phases[idx];
+        fprintf(fp, "    \"%s\": {\"wall\": %.9f, \"cpu\": %.9f, \"runs\": %lu, \"net_heap_growth\": %lld}%s\n", \
+                mlua_stats_phase_names[idx], \
+                record->wall, record->cpu, \
+                (unsigned long)record->runs, \
+                (long long)record->heap_growth, \
+                idx + 1 != MLUA_STATS_PHASE_COUNT ? "," : "");
+    }
+    fprintf(fp, "  },\n");
+    fprintf(fp, "  \"tokens\": %lu,\n", (unsigned long)stats->tokens);
+    fprintf(fp, "  \"ast_nodes\": %lu,\n", (unsigned long)stats->ast_nodes);
+    fprintf(fp, "  \"fcb_lines\": %lu,\n", (unsigned long)stats->fcb_lines);
+    fprintf(fp, "  \"lambdas\": %lu,\n", (unsigned long)stats->lambdas);
+    fprintf(fp, "  \"resource_ids\": %lu,\n", (unsigned long)stats->resource_ids);
+    fprintf(fp, "  \"instruments\": %lu\n", (unsigned long)stats->instruments);
+    fprintf(fp, "}\n");
+
+    return 0;
+}
+
@@ -0,0 +1,81 @@
+/* Multiple Lua Programming Language : Batch Compilation
+   Copyright(C) 2014 Cheryl Natsu
+
+   This file is part of multiple - Multiple Paradigm Language Interpreter
+
+   multiple is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   multiple is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#ifndef _MLUA_STATS_H_
+#define _MLUA_STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+enum mlua_stats_phase
+{
+    MLUA_STATS_PHASE_TOKENIZE = 0,
+    MLUA_STATS_PHASE_PARSE,
+    MLUA_STATS_PHASE_OPTIMIZE,
+    MLUA_STATS_PHASE_IRGEN,
+    MLUA_STATS_PHASE_MERGE,
+    MLUA_STATS_PHASE_COUNT
+};
+
+struct mlua_stats_phase_record
+{
+    /* Seconds, summed over every run of the phase */
+    double wall;
+    double cpu;
+    size_t runs;
+
+    /* Net growth of the heap in bytes over the phase, not the bytes it
+     * allocated; the heap is process wide, so it is only meaningful
+     * when a single thread compiles, 0 where the C library can not tell */
+    int64_t heap_growth;
+};
+
+struct mlua_stats
+{
+    struct mlua_stats_phase_record phases[MLUA_STATS_PHASE_COUNT];
+
+    /* Counters of the last compile */
+    size_t tokens;
+    size_t ast_nodes;
+    size_t fcb_lines;
+    size_t lambdas;
+    size_t resource_ids;
+    size_t instruments;
+};
+
+/* Snapshot taken when a phase begins */
+struct mlua_stats_probe
+{
+    double wall;
+    double cpu;
+    int64_t heap;
+};
+
+void mlua_stats_init(struct mlua_stats *stats);
+const char *mlua_stats_phase_name(enum mlua_stats_phase phase);
+
+/* 'stats' of NULL turns both into no-ops */
+void mlua_stats_probe_begin(struct mlua_stats *stats, struct mlua_stats_probe *probe);
+void mlua_stats_probe_end(struct mlua_stats *stats, struct mlua_stats_probe *probe, \
+        enum mlua_stats_phase phase);
+
+int mlua_stats_json_print(FILE *fp, struct mlua_stats *stats);
+
+#endif
+